@@ -0,0 +1,96 @@
+/*
+ * Arena.h
+ * Bump allocator: objects are carved out of large blocks and all released at once.
+ */
+
+#ifndef DA_TP_CLASSES_ARENA
+#define DA_TP_CLASSES_ARENA
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+/**
+ * Memory is taken from the system in blocks of at least blockSize bytes and
+ * handed out in allocation order, so objects allocated one after another
+ * are adjacent. Nothing is freed before the arena is destroyed (or cleared);
+ * destructors of the objects are the caller's business.
+ *
+ * Arenas can be moved but not copied.
+ */
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+    Arena(Arena &&) noexcept = default;
+    Arena &operator=(Arena &&) noexcept = default;
+
+    /*
+     * Uninitialized room for count objects of type U, contiguous.
+     */
+    template <class U>
+    U *allocate(size_t count = 1) {
+        return static_cast<U *>(allocateBytes(count * sizeof(U), alignof(U)));
+    }
+
+    /*
+     * Makes sure the next allocations of up to bytes in total fit in the
+     * current block, e.g. before allocating a known number of objects.
+     */
+    void reserve(size_t bytes);
+
+    void clear();
+
+    size_t getBytesUsed() const { return bytesUsed; }          // handed out, with alignment padding
+    size_t getBytesReserved() const { return bytesReserved; }  // taken from the system
+
+private:
+    size_t blockSize;
+    std::vector<std::unique_ptr<std::max_align_t[]>> blocks;
+    char *next = nullptr;       // free space of the current block
+    char *end = nullptr;
+    size_t bytesUsed = 0;
+    size_t bytesReserved = 0;
+
+    void *allocateBytes(size_t bytes, size_t alignment);
+    void newBlock(size_t bytes);
+};
+
+inline void *Arena::allocateBytes(size_t bytes, size_t alignment) {
+    auto align = [&](char *p) {
+        return reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(p) + alignment - 1) & ~(uintptr_t) (alignment - 1));
+    };
+    char *p = next == nullptr ? nullptr : align(next);
+    if (p == nullptr || bytes > (size_t) (end - p)) {
+        newBlock(bytes + alignment);
+        p = align(next);
+    }
+    bytesUsed += p + bytes - next;
+    next = p + bytes;
+    return p;
+}
+
+inline void Arena::reserve(size_t bytes) {
+    if (next == nullptr || bytes > (size_t) (end - next))
+        newBlock(bytes);
+}
+
+inline void Arena::newBlock(size_t bytes) {
+    size_t size = std::max(blockSize, bytes);
+    size_t units = (size + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+    blocks.emplace_back(new std::max_align_t[units]);
+    next = reinterpret_cast<char *>(blocks.back().get());
+    end = next + units * sizeof(std::max_align_t);
+    bytesReserved += units * sizeof(std::max_align_t);
+}
+
+inline void Arena::clear() {
+    blocks.clear();
+    next = end = nullptr;
+    bytesUsed = bytesReserved = 0;
+}
+
+#endif /* DA_TP_CLASSES_ARENA */
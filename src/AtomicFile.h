@@ -0,0 +1,63 @@
+/**
+ * @file AtomicFile.h
+ * @brief Writing a file under a temporary name and renaming it into place
+ */
+#ifndef ATOMIC_FILE_H
+#define ATOMIC_FILE_H
+
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+/**
+ * @brief Writes a file as a whole or not at all
+ *
+ * The contents go to "<filename>.tmp.<pid>", which is renamed over filename
+ * once complete: readers (and processes mapping the old file) see either the
+ * old file or the new one, never a truncated or half-written one, and a
+ * writer killed midway only leaves its temporary file behind.
+ */
+class AtomicFile {
+public:
+    /**
+     * @param contents Called with the temporary file, open in binary mode, to write the contents
+     * @throw runtime_error If the file cannot be created, written or renamed into
+     *        place; the temporary file is removed (as it is if contents throws)
+     */
+    template <class Contents>
+    static void write(const std::string& filename, Contents&& contents) {
+#ifndef _WIN32
+        std::string tempFile = filename + ".tmp." + std::to_string(getpid());
+#else
+        std::string tempFile = filename + ".tmp." + std::to_string(_getpid());
+#endif
+        std::ofstream out(tempFile, std::ios::binary);
+        if (!out.is_open()) throw std::runtime_error("ERRO: Não foi possível criar " + tempFile);
+
+        std::error_code ec;
+        try {
+            contents(out);
+        } catch (...) {
+            out.close();
+            std::filesystem::remove(tempFile, ec);
+            throw;
+        }
+        out.close();
+
+        if (out) std::filesystem::rename(tempFile, filename, ec);
+        if (!out || ec) {
+            std::filesystem::remove(tempFile, ec);
+            throw std::runtime_error("ERRO: Falha ao escrever " + filename);
+        }
+    }
+};
+
+#endif // ATOMIC_FILE_H
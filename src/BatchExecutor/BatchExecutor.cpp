@@ -0,0 +1,191 @@
+#include "BatchExecutor.h"
+#include <iostream>
+#include <sstream>
+#include <numeric>
+#include <chrono>
+#include <tuple>
+#include "../ThreadPool.h"
+#include "../RouteFinder/RouteFinder.h"
+#include "../RouteFinder/SearchOverlay.h"
+#include "../OutputWriter/OutputWriter.h"
+
+using namespace std;
+
+namespace {
+    /*
+     * Runs one query of a batch and writes its block: the output.txt result
+     * (or an Error line), QueryTimeUs and "---". Returns false if it was invalid.
+     */
+    bool runBatchQuery(const CsrGraph<int>& network, const unordered_map<int, bool>& parkingData,
+                       const Query& query, SearchContext& context, ostream& out,
+                       const ParkingTable* parkingTable, const ContractionHierarchy* hierarchy,
+                       const Landmarks* landmarks) {
+        auto t0 = chrono::steady_clock::now();
+        string error = BatchExecutor::validate(network, query);
+        if (error.empty()) {
+            BatchExecutor::execute(network, parkingData, query, context, out, parkingTable, hierarchy, landmarks);
+        } else {
+            out << "Source:" << query.start << "\n";
+            out << "Destination:" << query.end << "\n";
+            out << "Error:" << error << "\n";
+        }
+        auto t1 = chrono::steady_clock::now();
+
+        out << "QueryTimeUs:" << chrono::duration_cast<chrono::microseconds>(t1 - t0).count() << "\n";
+        out << "---\n";
+        return error.empty();
+    }
+}
+
+string BatchExecutor::validate(const CsrGraph<int>& network, const Query& query) {
+    if (query.start == -1 || query.end == -1) return "Origem/destino nao definidos";
+    if (network.findVertexIdx(query.start) == -1) return "No de origem nao existe";
+    if (network.findVertexIdx(query.end) == -1) return "No de destino nao existe";
+    return "";
+}
+
+void BatchExecutor::execute(const CsrGraph<int>& network, const unordered_map<int, bool>& parkingData,
+                            const Query& query, SearchContext& context, ostream& out,
+                            const ParkingTable* parkingTable,
+                            const ContractionHierarchy* hierarchy,
+                            const Landmarks* landmarks,
+                            bool verbose,
+                            ThreadPool* pool) {
+    int start = query.start, end = query.end;
+    SearchOverlay overlay(network, query.avoidNodes, query.avoidSegments);
+
+    if (query.mode == "driving-walking") {
+        vector<int> drivingRoute, walkingRoute;
+        int parkingNode, totalTime;
+        string message;
+        vector<tuple<int, vector<int>, vector<int>, int>> alternatives;
+
+        bool found = RouteFinder::findHybridRoute(network, context, parkingData, start, end, query.maxWalkTime,
+                                               overlay, drivingRoute, walkingRoute,
+                                               parkingNode, totalTime, message, &alternatives, parkingTable, pool);
+
+        if (verbose) {
+            if (found) {
+                cout << "\n=== ROTA ENCONTRADA ===" << endl;
+                cout << "Trajeto de carro: ";
+                for (int node : drivingRoute) cout << node << " ";
+                cout << "\nEstacionamento: " << parkingNode;
+                cout << "\nTrajeto a pe: ";
+                for (int node : walkingRoute) cout << node << " ";
+                cout << "\nTempo total: " << totalTime << " minutos" << endl;
+            } else {
+                cout << "\n=== RESULTADO ===" << endl;
+                cout << message << endl;
+            }
+        }
+
+        OutputWriter::writeHybridOutput(network, out, start, end,
+                                     drivingRoute, parkingNode, walkingRoute, totalTime,
+                                     message, alternatives);
+        return;
+    }
+
+    vector<int> bestPath, altPath;
+    int bestTime = 0, altTime = 0;
+    bool hasRestrictions = !query.avoidNodes.empty() || !query.avoidSegments.empty() || !query.includeNodes.empty();
+
+    bool found;
+    if (!query.includeNodes.empty()) {
+        found = RouteFinder::findRouteWithIncludeNodes(network, context, start, end, query.includeNodes,
+                                                       bestPath, bestTime, overlay, hierarchy, landmarks);
+    } else {
+        found = RouteFinder::dijkstra(network, context, start, end, bestPath, bestTime, true, overlay, hierarchy, landmarks);
+
+        if (!hasRestrictions && found) {
+            // Alternativa: por um no intermedio (duas arvores); se nenhum servir,
+            // a rota mais curta seguinte que nao repita demasiado a melhor
+            vector<pair<vector<int>, int>> routes;
+            RouteFinder::viaNodeAlternatives(network, context, start, end, 2, routes, true,
+                                             RouteFinder::VIA_MAX_STRETCH, ALTERNATIVE_MAX_OVERLAP,
+                                             RouteFinder::VIA_LOCAL_OPTIMALITY, overlay, &bestPath);
+            if (routes.size() < 2) {
+                RouteFinder::kShortestPaths(network, context, start, end, 2, routes, true,
+                                            ALTERNATIVE_MAX_OVERLAP, overlay, &bestPath);
+            }
+            if (routes.size() > 1) {
+                altPath = routes[1].first;
+                altTime = routes[1].second;
+            }
+        }
+    }
+
+    if (verbose) {
+        cout << "\n=== RESULTADOS ===" << endl;
+        if (found) {
+            cout << "Melhor rota (" << bestTime << " min): ";
+            for (size_t i = 0; i < bestPath.size(); i++) {
+                if (i != 0) cout << " -> ";
+                cout << bestPath[i];
+            }
+            cout << endl;
+
+            if (!altPath.empty()) {
+                cout << "\nRota alternativa (" << altTime << " min): ";
+                for (size_t i = 0; i < altPath.size(); i++) {
+                    if (i != 0) cout << " -> ";
+                    cout << altPath[i];
+                }
+                cout << endl;
+            }
+        } else {
+            cout << "Nenhuma rota encontrada" << endl;
+        }
+    }
+
+    OutputWriter::writeOutput(network, out, start, end,
+                           bestPath, bestTime, altPath, altTime, hasRestrictions);
+}
+
+int BatchExecutor::run(const CsrGraph<int>& network, const unordered_map<int, bool>& parkingData,
+                       const vector<Query>& queries, ostream& out,
+                       const ParkingTable* parkingTable,
+                       const ContractionHierarchy* hierarchy,
+                       const Landmarks* landmarks,
+                       unsigned threads) {
+    if (threads == 1 || queries.size() <= 1) {
+        SearchContext context(network.getNumVertex());
+        int invalid = 0;
+        for (const Query& query : queries) {
+            if (!runBatchQuery(network, parkingData, query, context, out, parkingTable, hierarchy, landmarks)) {
+                invalid++;
+            }
+        }
+        return invalid;
+    }
+
+    ThreadPool pool(threads);
+    return run(network, parkingData, queries, out, pool, parkingTable, hierarchy, landmarks);
+}
+
+int BatchExecutor::run(const CsrGraph<int>& network, const unordered_map<int, bool>& parkingData,
+                       const vector<Query>& queries, ostream& out, ThreadPool& pool,
+                       const ParkingTable* parkingTable,
+                       const ContractionHierarchy* hierarchy,
+                       const Landmarks* landmarks) {
+    vector<SearchContext> contexts;
+    for (unsigned w = 0; w < pool.size(); w++) contexts.emplace_back(network.getNumVertex());
+    vector<ostringstream> buffers(pool.size());
+    vector<int> invalid(pool.size(), 0);
+    vector<string> results;
+
+    for (size_t first = 0; first < queries.size(); first += BATCH_WINDOW) {
+        int count = min<size_t>(BATCH_WINDOW, queries.size() - first);
+        results.resize(count);
+        pool.parallelFor(count, [&](int i, unsigned w) {
+            ostringstream& buffer = buffers[w];
+            buffer.str("");
+            if (!runBatchQuery(network, parkingData, queries[first + i], contexts[w], buffer,
+                               parkingTable, hierarchy, landmarks)) {
+                invalid[w]++;
+            }
+            results[i] = buffer.str();
+        });
+        for (int i = 0; i < count; i++) out << results[i];
+    }
+    return accumulate(invalid.begin(), invalid.end(), 0);
+}
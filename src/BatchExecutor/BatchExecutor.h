@@ -0,0 +1,98 @@
+/**
+ * @file BatchExecutor.h
+ * @brief Runs route queries against a network loaded once
+ */
+#ifndef BATCH_EXECUTOR_H
+#define BATCH_EXECUTOR_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+#include "../CsrGraph.h"
+#include "../InputParser/InputParser.h"
+#include "../RouteFinder/SearchContext.h"
+#include "../ParkingTable/ParkingTable.h"
+#include "../ContractionHierarchy/ContractionHierarchy.h"
+#include "../Landmarks/Landmarks.h"
+#include "../ThreadPool.h"
+
+/**
+ * @class BatchExecutor
+ * @brief Answers parsed queries and writes their results in the output.txt format
+ *
+ * Used for the single query of input.txt, the manual input and whole batches,
+ * so every entry point picks the same engines for the same query.
+ */
+class BatchExecutor {
+public:
+    /**
+     * @brief Checks that a query can be run on the network
+     * @return Error message, empty if the query is valid
+     */
+    static string validate(const CsrGraph<int>& network, const Query& query);
+
+    /**
+     * @brief Runs one valid query and writes its result
+     * @param network CSR network of the roads
+     * @param parkingData Map of parking node availability
+     * @param query Query accepted by validate
+     * @param context Search workspace, reused between queries
+     * @param out Stream the result is written to
+     * @param parkingTable Optional precomputed parking walking times (see ParkingTable)
+     * @param hierarchy Optional contraction hierarchy for the driving queries
+     * @param landmarks Optional landmark distances for the restricted driving queries
+     * @param verbose Also print the result to the console
+     * @param pool Optional worker pool for the independent searches of a
+     *        driving-walking query (see RouteFinder::findHybridRoute)
+     */
+    static void execute(const CsrGraph<int>& network, const unordered_map<int, bool>& parkingData,
+                        const Query& query, SearchContext& context, ostream& out,
+                        const ParkingTable* parkingTable = nullptr,
+                        const ContractionHierarchy* hierarchy = nullptr,
+                        const Landmarks* landmarks = nullptr,
+                        bool verbose = false,
+                        ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Runs every query in input order, reusing the search workspaces
+     *
+     * Each result is written as soon as it is known, as in output.txt, followed by
+     * QueryTimeUs (microseconds spent on it) and a "---" line. Invalid queries get
+     * an Error line instead of routes, the others still run.
+     *
+     * With several threads the queries are spread over a ThreadPool, each worker
+     * with its own SearchContext and output buffer. Results are merged in input
+     * order every BATCH_WINDOW queries, so the output is the same as with one thread
+     * (except for the timings).
+     *
+     * @param threads Number of worker threads; 0 uses one per hardware thread.
+     *        With more than one, a pool is started for this batch only.
+     * @return Number of invalid queries
+     */
+    static int run(const CsrGraph<int>& network, const unordered_map<int, bool>& parkingData,
+                   const vector<Query>& queries, ostream& out,
+                   const ParkingTable* parkingTable = nullptr,
+                   const ContractionHierarchy* hierarchy = nullptr,
+                   const Landmarks* landmarks = nullptr,
+                   unsigned threads = 1);
+
+    /**
+     * @brief Same as above, on the workers of a pool that outlives the batch
+     * @param pool Workers for the queries; must not be running this call
+     */
+    static int run(const CsrGraph<int>& network, const unordered_map<int, bool>& parkingData,
+                   const vector<Query>& queries, ostream& out, ThreadPool& pool,
+                   const ParkingTable* parkingTable = nullptr,
+                   const ContractionHierarchy* hierarchy = nullptr,
+                   const Landmarks* landmarks = nullptr);
+
+    static constexpr int BATCH_WINDOW = 4096;
+    /**
+     * @brief Largest fraction of the alternative driving route's time, and of
+     *        its segments, that may be on segments of the best route
+     */
+    static constexpr double ALTERNATIVE_MAX_OVERLAP = 0.8;
+};
+
+#endif // BATCH_EXECUTOR_H
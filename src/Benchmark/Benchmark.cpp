@@ -0,0 +1,769 @@
+/**
+ * @file Benchmark.cpp
+ * @brief Timing harness for the route finding engines
+ *
+ * Usage: RouteBenchmark <benchmark> [queries] [dataDir]
+ *   hybrid   findHybridRoute with HybridEngine::TwoTrees vs HybridEngine::Layered
+ *   p2p      dijkstra vs bidirectionalDijkstra, driving and walking
+ *   ch       driving dijkstra vs the contraction hierarchy (and its preprocessing)
+ *   alt      dijkstra vs A* with landmarks, with 10 random avoided nodes per query
+ *   queues   every QueuePolicy on point-to-point, one-to-all and A* searches
+ *   heap     replays the heap operations of one-to-all driving searches on every queue
+ *   parallel findHybridRoute (with alternatives) on one thread vs on a ThreadPool
+ *   startup  parsing the CSV files into a CsrGraph vs mapping a GraphSnapshot
+ *   alloc    heap allocations per query of Graph adjacency walks and CSR searches
+ *   snapshot Graph copies (shared) vs copies with one vertex removed (deep copy)
+ *   yen      kShortestPaths for K=2..10 vs Yen with a plain Dijkstra per spur
+ *   via      viaNodeAlternatives vs kShortestPaths for the driving alternatives
+ *   stops    orderStops exact vs heuristic, and findRouteWithIncludeNodes for 5..30 stops
+ *
+ * Queries are random source/destination pairs from a fixed seed, so runs
+ * are comparable between builds.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <climits>
+#include <set>
+#include <cstdlib>
+#include <new>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include "../Graph.h"
+#include "../CsrGraph.h"
+#include "../FileParser/FileParser.h"
+#include "../RouteFinder/RouteFinder.h"
+#include "../ContractionHierarchy/ContractionHierarchy.h"
+#include "../Landmarks/Landmarks.h"
+#include "../ThreadPool.h"
+#include "../GraphSnapshot/GraphSnapshot.h"
+
+using namespace std;
+
+/*
+ * Every allocation of the calling thread is counted, for the alloc benchmark.
+ */
+namespace {
+    thread_local size_t allocations = 0;
+}
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+namespace {
+    struct Query {
+        int start, end, maxWalkTime;
+    };
+
+    vector<Query> randomQueries(const CsrGraph<int>& network, int count) {
+        mt19937 rng(2025);
+        uniform_int_distribution<int> node(0, network.getNumVertex() - 1);
+        uniform_int_distribution<int> walk(5, 60);
+        vector<Query> queries;
+        for (int i = 0; i < count; i++) {
+            queries.push_back({network.getInfo(node(rng)), network.getInfo(node(rng)), walk(rng)});
+        }
+        return queries;
+    }
+
+    /*
+     * Runs fn once per query and prints the mean time per query.
+     */
+    void report(const string& name, const vector<Query>& queries, const function<void(const Query&)>& fn) {
+        auto t0 = chrono::steady_clock::now();
+        for (const auto& q : queries) fn(q);
+        auto t1 = chrono::steady_clock::now();
+        double us = chrono::duration<double, micro>(t1 - t0).count() / queries.size();
+        cout << left << setw(32) << name << right << setw(12) << fixed << setprecision(1) << us << " us/query" << endl;
+    }
+
+    void benchHybrid(const CsrGraph<int>& network, const unordered_map<int, bool>& parkingData,
+                     const vector<Query>& queries) {
+        SearchContext context(network.getNumVertex());
+        SearchOverlay overlay;
+        vector<int> treeTimes, layeredTimes;
+
+        report("hybrid/two-trees", queries, [&](const Query& q) {
+            vector<int> drivingRoute, walkingRoute;
+            int parkingNode, totalTime = -1;
+            string message;
+            bool found = RouteFinder::findHybridRoute(network, context, parkingData, q.start, q.end, q.maxWalkTime,
+                                                      overlay, drivingRoute, walkingRoute,
+                                                      parkingNode, totalTime, message, nullptr);
+            treeTimes.push_back(found ? totalTime : -1);
+        });
+        context.setHybridEngine(HybridEngine::Layered);
+        report("hybrid/layered", queries, [&](const Query& q) {
+            vector<int> drivingRoute, walkingRoute;
+            int parkingNode, totalTime = -1;
+            string message;
+            bool found = RouteFinder::findHybridRoute(network, context, parkingData, q.start, q.end, q.maxWalkTime,
+                                                      overlay, drivingRoute, walkingRoute,
+                                                      parkingNode, totalTime, message, nullptr);
+            layeredTimes.push_back(found ? totalTime : -1);
+        });
+
+        int mismatches = 0;
+        for (size_t i = 0; i < queries.size(); i++) {
+            if (treeTimes[i] != layeredTimes[i]) mismatches++;
+        }
+        cout << "total time mismatches: " << mismatches << endl;
+    }
+
+    void benchParallelHybrid(const CsrGraph<int>& network, const unordered_map<int, bool>& parkingData,
+                             const vector<Query>& queries) {
+        SearchContext context(network.getNumVertex());
+        SearchOverlay overlay;
+        ThreadPool pool(max(2u, min(4u, thread::hardware_concurrency())));
+        using Result = tuple<vector<int>, vector<int>, int, vector<tuple<int, vector<int>, vector<int>, int>>>;
+
+        vector<Result> results[2];
+        for (int parallel = 0; parallel < 2; parallel++) {
+            string name = parallel ? "hybrid/pool-" + to_string(pool.size()) : "hybrid/sequential";
+            report(name, queries, [&](const Query& q) {
+                vector<int> drivingRoute, walkingRoute;
+                int parkingNode, totalTime = -1;
+                string message;
+                vector<tuple<int, vector<int>, vector<int>, int>> alternatives;
+                bool found = RouteFinder::findHybridRoute(network, context, parkingData, q.start, q.end, q.maxWalkTime,
+                                                          overlay, drivingRoute, walkingRoute, parkingNode, totalTime,
+                                                          message, &alternatives, nullptr, parallel ? &pool : nullptr);
+                results[parallel].emplace_back(drivingRoute, walkingRoute, found ? totalTime : -1, alternatives);
+            });
+        }
+
+        int mismatches = 0;
+        for (size_t i = 0; i < queries.size(); i++) {
+            if (results[0][i] != results[1][i]) mismatches++;
+        }
+        cout << "result mismatches: " << mismatches << endl;
+    }
+
+    void benchPointToPoint(const CsrGraph<int>& network, const vector<Query>& queries) {
+        SearchContext forward(network.getNumVertex()), backward(network.getNumVertex());
+
+        for (bool driving : {true, false}) {
+            string mode = driving ? "driving" : "walking";
+            vector<int> uniTimes, biTimes;
+            long uniSettled = 0, biSettled = 0;
+
+            report("p2p/dijkstra/" + mode, queries, [&](const Query& q) {
+                vector<int> path;
+                int time = -1;
+                bool found = RouteFinder::dijkstra(network, forward, q.start, q.end, path, time, driving);
+                uniTimes.push_back(found ? time : -1);
+                uniSettled += forward.getNumSettled();
+            });
+            report("p2p/bidirectional/" + mode, queries, [&](const Query& q) {
+                vector<int> path;
+                int time = -1;
+                bool found = RouteFinder::bidirectionalDijkstra(network, forward, backward, q.start, q.end,
+                                                                path, time, driving);
+                biTimes.push_back(found ? time : -1);
+                biSettled += forward.getNumSettled() + backward.getNumSettled();
+            });
+
+            int mismatches = 0;
+            for (size_t i = 0; i < queries.size(); i++) {
+                if (uniTimes[i] != biTimes[i]) mismatches++;
+            }
+            cout << "settled nodes per query: " << uniSettled / queries.size() << " vs "
+                 << biSettled / queries.size() << ", time mismatches: " << mismatches << endl;
+        }
+    }
+
+    void benchHierarchy(const Graph<int>& roadNetwork, const CsrGraph<int>& network, const vector<Query>& queries) {
+        auto t0 = chrono::steady_clock::now();
+        ContractionHierarchy hierarchy(roadNetwork);
+        auto t1 = chrono::steady_clock::now();
+        cout << "preprocessing: " << chrono::duration<double, milli>(t1 - t0).count() << " ms, "
+             << hierarchy.getNumShortcuts() << " shortcuts" << endl;
+
+        SearchContext context(network.getNumVertex());
+        vector<int> dijkstraTimes, hierarchyTimes;
+        long dijkstraSettled = 0, hierarchySettled = 0;
+
+        report("ch/dijkstra", queries, [&](const Query& q) {
+            vector<int> path;
+            int time = -1;
+            bool found = RouteFinder::dijkstra(network, context, q.start, q.end, path, time, true);
+            dijkstraTimes.push_back(found ? time : -1);
+            dijkstraSettled += context.getNumSettled();
+        });
+        report("ch/query", queries, [&](const Query& q) {
+            vector<int> path;
+            int time = -1;
+            bool found = RouteFinder::dijkstra(network, context, q.start, q.end, path, time, true,
+                                               SearchOverlay(), &hierarchy);
+            hierarchyTimes.push_back(found ? time : -1);
+            hierarchySettled += context.getNumSettled();
+        });
+
+        int mismatches = 0;
+        for (size_t i = 0; i < queries.size(); i++) {
+            if (dijkstraTimes[i] != hierarchyTimes[i]) mismatches++;
+        }
+        cout << "settled nodes per query: " << dijkstraSettled / queries.size() << " vs "
+             << hierarchySettled / queries.size() << ", time mismatches: " << mismatches << endl;
+    }
+
+    void benchLandmarks(const CsrGraph<int>& network, const vector<Query>& queries) {
+        auto t0 = chrono::steady_clock::now();
+        Landmarks landmarks = Landmarks::build(network, 16);
+        auto t1 = chrono::steady_clock::now();
+        cout << "preprocessing: " << chrono::duration<double, milli>(t1 - t0).count() << " ms, "
+             << landmarks.getCount() << " landmarks per mode" << endl;
+
+        // the same avoided nodes for both engines, never the query ends
+        mt19937 rng(7);
+        uniform_int_distribution<int> node(0, network.getNumVertex() - 1);
+        vector<SearchOverlay> overlays;
+        for (const auto& q : queries) {
+            vector<int> avoidNodes;
+            while (avoidNodes.size() < 10) {
+                int v = network.getInfo(node(rng));
+                if (v != q.start && v != q.end) avoidNodes.push_back(v);
+            }
+            overlays.emplace_back(network, avoidNodes, vector<pair<int, int>>());
+        }
+
+        SearchContext context(network.getNumVertex());
+        for (bool driving : {true, false}) {
+            string mode = driving ? "driving" : "walking";
+            vector<int> dijkstraTimes, altTimes;
+            long dijkstraSettled = 0, altSettled = 0;
+            size_t i = 0;
+
+            report("alt/dijkstra/" + mode, queries, [&](const Query& q) {
+                vector<int> path;
+                int time = -1;
+                bool found = RouteFinder::dijkstra(network, context, q.start, q.end, path, time, driving,
+                                                   overlays[i++]);
+                dijkstraTimes.push_back(found ? time : -1);
+                dijkstraSettled += context.getNumSettled();
+            });
+            i = 0;
+            report("alt/landmarks/" + mode, queries, [&](const Query& q) {
+                vector<int> path;
+                int time = -1;
+                bool found = RouteFinder::dijkstra(network, context, q.start, q.end, path, time, driving,
+                                                   overlays[i++], nullptr, &landmarks);
+                altTimes.push_back(found ? time : -1);
+                altSettled += context.getNumSettled();
+            });
+
+            int mismatches = 0;
+            for (size_t k = 0; k < queries.size(); k++) {
+                if (dijkstraTimes[k] != altTimes[k]) mismatches++;
+            }
+            cout << "settled nodes per query: " << dijkstraSettled / queries.size() << " vs "
+                 << altSettled / queries.size() << ", time mismatches: " << mismatches << endl;
+        }
+    }
+
+    void benchQueues(const CsrGraph<int>& network, const vector<Query>& queries) {
+        Landmarks landmarks = Landmarks::build(network, 16);
+        const pair<QueuePolicy, string> policies[] = {
+            {QueuePolicy::BinaryHeap, "binary"}, {QueuePolicy::QuaternaryHeap, "4-ary"},
+            {QueuePolicy::Dial, "dial"}, {QueuePolicy::Radix, "radix"},
+            {QueuePolicy::DaryHeap4, "inline-4"}, {QueuePolicy::DaryHeap8, "inline-8"},
+            {QueuePolicy::LazyDaryHeap4, "lazy-4"}, {QueuePolicy::LazyDaryHeap8, "lazy-8"},
+            {QueuePolicy::Auto, "auto"}};
+
+        SearchContext context(network.getNumVertex());
+        for (bool driving : {true, false}) {
+            string mode = driving ? "driving" : "walking";
+            for (const auto& [policy, name] : policies) {
+                context.setQueuePolicy(policy);
+                report("queues/p2p/" + mode + "/" + name, queries, [&](const Query& q) {
+                    vector<int> path;
+                    int time;
+                    RouteFinder::dijkstra(network, context, q.start, q.end, path, time, driving);
+                });
+            }
+            for (const auto& [policy, name] : policies) {
+                context.setQueuePolicy(policy);
+                report("queues/tree/" + mode + "/" + name, queries, [&](const Query& q) {
+                    RouteFinder::shortestPathTree(network, context, q.start, driving, false);
+                });
+            }
+            for (const auto& [policy, name] : policies) {
+                context.setQueuePolicy(policy);
+                report("queues/alt/" + mode + "/" + name, queries, [&](const Query& q) {
+                    vector<int> path;
+                    int time;
+                    RouteFinder::dijkstra(network, context, q.start, q.end, path, time, driving,
+                                          SearchOverlay(), nullptr, &landmarks);
+                });
+            }
+        }
+    }
+
+    struct HeapOp {
+        char kind;      // 'i'nsert, 'd'ecreaseKey, 'e'xtractMin, 'c'lear
+        int index;
+        int key;
+    };
+
+    /*
+     * Heap operations of a one-to-all driving search from every query start.
+     */
+    vector<HeapOp> recordHeapOps(const CsrGraph<int>& network, const vector<Query>& queries) {
+        vector<HeapOp> ops;
+        SearchContext context(network.getNumVertex());
+        auto& pq = context.queue();
+
+        for (const auto& q : queries) {
+            context.reset(network.getNumVertex());
+            ops.push_back({'c', -1, 0});
+            int source = network.findVertexIdx(q.start);
+            context[source].dist = 0;
+            pq.insert(&context[source]);
+            ops.push_back({'i', source, 0});
+
+            while (!pq.empty()) {
+                SearchContext::Node* current = pq.extractMin();
+                current->visited = true;
+                ops.push_back({'e', -1, 0});
+                int u = context.indexOf(current);
+                for (int e = network.edgesBegin(u); e < network.edgesEnd(u); e++) {
+                    if (network.getWeight(e) < 0) continue;
+                    SearchContext::Node& neighbor = context[network.getDest(e)];
+                    int newDist = current->dist + network.getWeight(e);
+                    if (neighbor.visited || newDist >= neighbor.dist) continue;
+                    neighbor.dist = newDist;
+                    ops.push_back({neighbor.queueIndex == 0 ? 'i' : 'd', network.getDest(e), newDist});
+                    if (neighbor.queueIndex == 0) pq.insert(&neighbor);
+                    else pq.decreaseKey(&neighbor);
+                }
+            }
+        }
+        return ops;
+    }
+
+    template <class Queue>
+    void bindItems(Queue&, SearchContext::Node*) {}
+
+    template <unsigned D, bool Lazy>
+    void bindItems(DaryHeap<SearchContext::Node, D, Lazy>& queue, SearchContext::Node* items) {
+        queue.setItems(items);
+    }
+
+    template <class Queue>
+    void replay(const string& name, const vector<HeapOp>& ops, int numVertex, Queue& queue) {
+        vector<SearchContext::Node> items(numVertex);
+        bindItems(queue, items.data());
+
+        auto t0 = chrono::steady_clock::now();
+        for (const HeapOp& op : ops) {
+            switch (op.kind) {
+                case 'c':
+                    fill(items.begin(), items.end(), SearchContext::Node());
+                    queue.clear();
+                    break;
+                case 'i':
+                    items[op.index].dist = op.key;
+                    queue.insert(&items[op.index]);
+                    break;
+                case 'd':
+                    items[op.index].dist = op.key;
+                    queue.decreaseKey(&items[op.index]);
+                    break;
+                default:
+                    queue.extractMin();
+            }
+        }
+        auto t1 = chrono::steady_clock::now();
+        double ns = chrono::duration<double, nano>(t1 - t0).count() / ops.size();
+        cout << left << setw(32) << name << right << setw(12) << fixed << setprecision(1) << ns << " ns/op" << endl;
+    }
+
+    void benchHeaps(const CsrGraph<int>& network, const vector<Query>& queries) {
+        vector<HeapOp> ops = recordHeapOps(network, queries);
+        cout << ops.size() << " heap operations" << endl;
+
+        int n = network.getNumVertex();
+        SearchContext::BinaryHeap binary;
+        SearchContext::QuaternaryHeap quaternary;
+        SearchContext::DialQueue dial(network.getMaxWeight());
+        SearchContext::RadixQueue radix;
+        SearchContext::DaryHeap4 inline4;
+        SearchContext::DaryHeap8 inline8;
+        SearchContext::LazyDaryHeap4 lazy4;
+        SearchContext::LazyDaryHeap8 lazy8;
+        replay("heap/binary", ops, n, binary);
+        replay("heap/4-ary", ops, n, quaternary);
+        replay("heap/dial", ops, n, dial);
+        replay("heap/radix", ops, n, radix);
+        replay("heap/inline-4", ops, n, inline4);
+        replay("heap/inline-8", ops, n, inline8);
+        replay("heap/lazy-4", ops, n, lazy4);
+        replay("heap/lazy-8", ops, n, lazy8);
+    }
+
+    /*
+     * Runs fn once per query and prints the mean number of heap allocations
+     * per query, after a warm-up pass so reused buffers already have their size.
+     */
+    void reportAllocations(const string& name, const vector<Query>& queries, const function<void(const Query&)>& fn) {
+        for (const auto& q : queries) fn(q);
+        size_t before = allocations;
+        report(name, queries, fn);
+        double perQuery = double(allocations - before) / queries.size();
+        cout << left << setw(32) << name << right << setw(12) << fixed << setprecision(1) << perQuery
+             << " allocations/query" << endl;
+    }
+
+    void benchAllocations(const Graph<int>& roadNetwork, const CsrGraph<int>& network, const vector<Query>& queries) {
+        // breadth-first walk over the Vertex/Edge adjacency lists, buffers reused
+        vector<const Vertex<int>*> frontier;
+        unordered_map<const Vertex<int>*, bool> seen;
+        frontier.reserve(roadNetwork.getNumVertex());
+        seen.reserve(roadNetwork.getNumVertex());
+        long reached = 0;
+        reportAllocations("alloc/graph-walk", queries, [&](const Query& q) {
+            for (auto& entry : seen) entry.second = false;
+            frontier.assign(1, roadNetwork.findVertex(q.start));
+            seen[frontier[0]] = true;
+            for (size_t i = 0; i < frontier.size(); i++) {
+                for (const Edge<int>* e : frontier[i]->getAdj()) {
+                    bool& s = seen[e->getDest()];
+                    if (!s) {
+                        s = true;
+                        frontier.push_back(e->getDest());
+                    }
+                }
+                for (const Edge<int>* e : frontier[i]->getIncoming()) reached += e->getWalkingWeight() > 0;
+            }
+            reached += frontier.size();
+        });
+
+        SearchContext context(network.getNumVertex());
+        vector<int> path;
+        reportAllocations("alloc/csr-dijkstra", queries, [&](const Query& q) {
+            int time = -1;
+            path.clear();
+            RouteFinder::dijkstra(network, context, q.start, q.end, path, time, true);
+            reached += time;
+        });
+        cout << "checksum: " << reached << endl;
+        cout << "graph arenas: " << roadNetwork.getMemoryReserved() / 1024 << " KiB" << endl;
+    }
+
+    /*
+     * Yen's algorithm without the shortest-path tree: one driving Dijkstra
+     * per spur node, as a reference for kShortestPaths. Returns the times.
+     */
+    vector<int> plainYen(const CsrGraph<int>& network, SearchContext& context, int start, int end, int k) {
+        vector<int> path, times;
+        int time;
+        if (!RouteFinder::dijkstra(network, context, start, end, path, time, true)) return times;
+        vector<vector<int>> found{path};
+        times.push_back(time);
+        set<pair<int, vector<int>>> candidates;
+        set<vector<int>> seen{path};
+        auto prefixTime = [&](const vector<int>& p, size_t len) {
+            int t = 0;
+            for (size_t i = 0; i + 1 < len; i++) {
+                int best = INT_MAX;
+                int u = network.findVertexIdx(p[i]), v = network.findVertexIdx(p[i + 1]);
+                for (int e = network.edgesBegin(u); e < network.edgesEnd(u); e++) {
+                    if (network.getDest(e) == v && network.getWeight(e) >= 0) best = min(best, network.getWeight(e));
+                }
+                t += best;
+            }
+            return t;
+        };
+        while ((int) found.size() < k) {
+            const vector<int> prev = found.back();
+            for (size_t i = 0; i + 1 < prev.size(); i++) {
+                vector<int> rootNodes(prev.begin(), prev.begin() + i);
+                vector<pair<int, int>> segments;
+                for (const auto& p : found) {
+                    if (p.size() > i + 1 && equal(p.begin(), p.begin() + i + 1, prev.begin()))
+                        segments.emplace_back(p[i], p[i + 1]);
+                }
+                SearchOverlay overlay(network, rootNodes, {});
+                for (auto [a, b] : segments) overlay.blockEdge(network.findVertexIdx(a), network.findVertexIdx(b));
+                vector<int> spurPath;
+                int spurTime;
+                if (!RouteFinder::dijkstra(network, context, prev[i], end, spurPath, spurTime, true, overlay)) continue;
+                vector<int> nodes(prev.begin(), prev.begin() + i);
+                nodes.insert(nodes.end(), spurPath.begin(), spurPath.end());
+                if (seen.insert(nodes).second) candidates.emplace(prefixTime(prev, i + 1) + spurTime, nodes);
+            }
+            if (candidates.empty()) break;
+            found.push_back(candidates.begin()->second);
+            times.push_back(candidates.begin()->first);
+            candidates.erase(candidates.begin());
+        }
+        return times;
+    }
+
+    void benchYen(const CsrGraph<int>& network, const vector<Query>& queries) {
+        SearchContext context(network.getNumVertex());
+        for (int k = 2; k <= 10; k++) {
+            vector<vector<int>> yenTimes, plainTimes;
+            report("yen/k=" + to_string(k), queries, [&](const Query& q) {
+                vector<pair<vector<int>, int>> routes;
+                RouteFinder::kShortestPaths(network, context, q.start, q.end, k, routes);
+                vector<int> times;
+                for (const auto& route : routes) times.push_back(route.second);
+                yenTimes.push_back(times);
+            });
+            report("yen/plain-k=" + to_string(k), queries, [&](const Query& q) {
+                plainTimes.push_back(plainYen(network, context, q.start, q.end, k));
+            });
+            int mismatches = 0;
+            for (size_t i = 0; i < queries.size(); i++) mismatches += yenTimes[i] != plainTimes[i];
+            cout << "k=" << k << " time mismatches: " << mismatches << endl;
+        }
+    }
+
+    /*
+     * Alternatives with at most 80% of their time shared, as BatchExecutor
+     * asks for: how many queries get k - 1 of them and their mean stretch.
+     */
+    void benchVia(const CsrGraph<int>& network, const vector<Query>& queries) {
+        SearchContext context(network.getNumVertex());
+        const double maxOverlap = 0.8;
+        for (int k = 2; k <= 4; k++) {
+            for (int via = 1; via >= 0; via--) {
+                int complete = 0;
+                double stretch = 0;
+                int alternatives = 0;
+                report((via ? "via/k=" : "yen/k=") + to_string(k), queries, [&](const Query& q) {
+                    vector<pair<vector<int>, int>> routes;
+                    if (via) {
+                        RouteFinder::viaNodeAlternatives(network, context, q.start, q.end, k, routes, true,
+                                                         RouteFinder::VIA_MAX_STRETCH, maxOverlap);
+                    } else {
+                        RouteFinder::kShortestPaths(network, context, q.start, q.end, k, routes, true, maxOverlap);
+                    }
+                    complete += (int) routes.size() == k;
+                    for (size_t i = 1; i < routes.size(); i++) {
+                        if (routes[0].second > 0) stretch += (double) routes[i].second / routes[0].second;
+                        alternatives++;
+                    }
+                });
+                cout << "  " << complete << "/" << queries.size() << " with " << k - 1
+                     << " alternatives, mean stretch " << setprecision(3)
+                     << (alternatives ? stretch / alternatives : 0) << endl;
+            }
+        }
+    }
+
+    /*
+     * Random stops for every query, the same for every run.
+     */
+    vector<vector<int>> randomStops(const CsrGraph<int>& network, const vector<Query>& queries, int count) {
+        mt19937 rng(count);
+        uniform_int_distribution<int> node(0, network.getNumVertex() - 1);
+        vector<vector<int>> stops(queries.size());
+        for (auto& s : stops) {
+            for (int i = 0; i < count; i++) s.push_back(network.getInfo(node(rng)));
+        }
+        return stops;
+    }
+
+    void benchStops(const CsrGraph<int>& network, const vector<Query>& queries) {
+        SearchContext context(network.getNumVertex());
+
+        // the same tables ordered both ways, up to the exact limit
+        for (int count : {3, 5, 8, 10, RouteFinder::HELD_KARP_MAX_STOPS}) {
+            auto stops = randomStops(network, queries, count);
+            vector<vector<vector<int>>> tables;
+            for (size_t q = 0; q < queries.size(); q++) {
+                vector<int> points{queries[q].start};
+                points.insert(points.end(), stops[q].begin(), stops[q].end());
+                points.push_back(queries[q].end);
+                vector<vector<int>> times(points.size(), vector<int>(points.size(), SearchContext::UNREACHABLE));
+                for (size_t i = 0; i + 1 < points.size(); i++) {
+                    RouteFinder::shortestPathTree(network, context, points[i], true, false);
+                    for (size_t j = 1; j < points.size(); j++) {
+                        if (j != i) times[i][j] = context[network.findVertexIdx(points[j])].dist;
+                    }
+                }
+                tables.push_back(times);
+            }
+
+            vector<long long> exactTimes, heuristicTimes;
+            size_t q = 0;
+            report("stops/held-karp-" + to_string(count), queries, [&](const Query&) {
+                vector<int> order;
+                exactTimes.push_back(RouteFinder::orderStops(tables[q++], order, true));
+            });
+            q = 0;
+            report("stops/2opt-oropt-" + to_string(count), queries, [&](const Query&) {
+                vector<int> order;
+                heuristicTimes.push_back(RouteFinder::orderStops(tables[q++], order, false));
+            });
+            int worse = 0;
+            double gap = 0;
+            for (size_t i = 0; i < queries.size(); i++) {
+                if (heuristicTimes[i] != exactTimes[i]) worse++;
+                if (exactTimes[i] > 0) gap += (double) (heuristicTimes[i] - exactTimes[i]) / exactTimes[i];
+            }
+            cout << "  heuristic worse on " << worse << "/" << queries.size() << " queries, mean gap "
+                 << setprecision(2) << 100 * gap / queries.size() << "%" << endl;
+        }
+
+        // whole queries, checked to visit every stop
+        for (int count : {5, 10, 20, 30}) {
+            auto stops = randomStops(network, queries, count);
+            size_t q = 0;
+            int missing = 0;
+            report("stops/route-" + to_string(count), queries, [&](const Query& query) {
+                vector<int> path;
+                int time;
+                const vector<int>& include = stops[q++];
+                if (!RouteFinder::findRouteWithIncludeNodes(network, context, query.start, query.end, include, path, time)) return;
+                for (int stop : include) missing += find(path.begin(), path.end(), stop) == path.end();
+            });
+            cout << "  stops missing from the routes: " << missing << endl;
+        }
+    }
+
+    /*
+     * What-if variants of the base graph: a plain copy shares it, removing a
+     * vertex from the copy deep-copies it. The base must not change.
+     */
+    void benchSnapshots(const Graph<int>& roadNetwork, const vector<Query>& queries) {
+        int numEdges = CsrGraph<int>(roadNetwork).getNumEdges();
+        long shared = 0;
+        report("snapshot/copy", queries, [&](const Query&) {
+            Graph<int> variant = roadNetwork;
+            shared += variant.isShared();
+        });
+        report("snapshot/copy-remove-vertex", queries, [&](const Query& q) {
+            Graph<int> variant = roadNetwork;
+            variant.removeVertex(q.start);
+            shared += variant.isShared();
+        });
+        bool unchanged = CsrGraph<int>(roadNetwork).getNumEdges() == numEdges;
+        cout << "shared copies: " << shared << ", base unchanged: " << (unchanged ? "yes" : "NO") << endl;
+    }
+
+    /*
+     * Times count loads of the network both ways and checks the snapshot
+     * holds the same arrays.
+     */
+    void benchStartup(const CsrGraph<int>& network, const string& dataDir, int count) {
+        string snapshotFile = dataDir + "/benchmark_network.bin";
+        auto time = [&](const string& name, const function<void()>& fn) {
+            auto t0 = chrono::steady_clock::now();
+            for (int i = 0; i < count; i++) fn();
+            auto t1 = chrono::steady_clock::now();
+            double ms = chrono::duration<double, milli>(t1 - t0).count() / count;
+            cout << left << setw(32) << name << right << setw(12) << fixed << setprecision(3) << ms << " ms/load" << endl;
+        };
+
+        time("startup/csv", [&]() {
+            Graph<int> roadNetwork;
+            unordered_map<int, bool> parkingData;
+            auto codeToId = FileParser::loadLocationMappings(dataDir + "/locations.csv", parkingData);
+            FileParser::loadGraph(roadNetwork, dataDir + "/Distances.csv", codeToId);
+            CsrGraph<int> parsed(roadNetwork);
+        });
+
+        unordered_map<int, bool> parkingData;
+        auto codeToId = FileParser::loadLocationMappings(dataDir + "/locations.csv", parkingData);
+        time("startup/snapshot-write", [&]() {
+            GraphSnapshot::write(snapshotFile, network, codeToId, parkingData);
+        });
+        time("startup/snapshot-map", [&]() {
+            GraphSnapshot snapshot = GraphSnapshot::load(snapshotFile);
+        });
+
+        GraphSnapshot snapshot = GraphSnapshot::load(snapshotFile);
+        const CsrGraph<int>& mapped = snapshot.getNetwork();
+        int mismatches = 0;
+        for (int v = 0; v < network.getNumVertex(); v++) {
+            if (mapped.getInfo(v) != network.getInfo(v) || mapped.findVertexIdx(network.getInfo(v)) != v
+                || mapped.edgesEnd(v) != network.edgesEnd(v) || mapped.incomingEnd(v) != network.incomingEnd(v)) {
+                mismatches++;
+            }
+        }
+        for (int e = 0; e < network.getNumEdges(); e++) {
+            if (mapped.getDest(e) != network.getDest(e) || mapped.getWeight(e) != network.getWeight(e)
+                || mapped.getWalkingWeight(e) != network.getWalkingWeight(e)
+                || mapped.getIncomingEdge(e) != network.getIncomingEdge(e)) {
+                mismatches++;
+            }
+        }
+        if (snapshot.getParkingData() != parkingData || snapshot.getCodeToId() != codeToId) mismatches++;
+        cout << "startup mismatches: " << mismatches << endl;
+        remove(snapshotFile.c_str());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    string benchmark = argc > 1 ? argv[1] : "hybrid";
+    int count = argc > 2 ? stoi(argv[2]) : 1000;
+    string dataDir = argc > 3 ? argv[3] : "../data";
+
+    try {
+        Graph<int> roadNetwork;
+        unordered_map<int, bool> parkingData;
+        auto codeToId = FileParser::loadLocationMappings(dataDir + "/locations.csv", parkingData);
+        FileParser::loadGraph(roadNetwork, dataDir + "/Distances.csv", codeToId);
+        CsrGraph<int> network(roadNetwork);
+
+        cout << network.getNumVertex() << " nodes, " << network.getNumEdges() << " edges, "
+             << count << " queries" << endl;
+        auto queries = randomQueries(network, count);
+
+        if (benchmark == "hybrid") {
+            benchHybrid(network, parkingData, queries);
+        } else if (benchmark == "p2p") {
+            benchPointToPoint(network, queries);
+        } else if (benchmark == "ch") {
+            benchHierarchy(roadNetwork, network, queries);
+        } else if (benchmark == "alt") {
+            benchLandmarks(network, queries);
+        } else if (benchmark == "queues") {
+            benchQueues(network, queries);
+        } else if (benchmark == "heap") {
+            benchHeaps(network, queries);
+        } else if (benchmark == "parallel") {
+            benchParallelHybrid(network, parkingData, queries);
+        } else if (benchmark == "alloc") {
+            benchAllocations(roadNetwork, network, queries);
+        } else if (benchmark == "yen") {
+            benchYen(network, queries);
+        } else if (benchmark == "via") {
+            benchVia(network, queries);
+        } else if (benchmark == "stops") {
+            benchStops(network, queries);
+        } else if (benchmark == "snapshot") {
+            benchSnapshots(roadNetwork, queries);
+        } else if (benchmark == "startup") {
+            benchStartup(network, dataDir, count);
+        } else {
+            cerr << "Unknown benchmark: " << benchmark << endl;
+            return 1;
+        }
+        return 0;
+    }
+    catch (const exception& e) {
+        cerr << "ERRO FATAL: " << e.what() << endl;
+        return 1;
+    }
+}
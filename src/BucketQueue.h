@@ -0,0 +1,118 @@
+/*
+ * BucketQueue.h
+ * Dial's bucket queue: a monotone priority queue for small integer weights.
+ */
+
+#ifndef DA_TP_CLASSES_BUCKETQUEUE
+#define DA_TP_CLASSES_BUCKETQUEUE
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <climits>
+
+/**
+ * class T must have: (i) accessible field int queueIndex; (ii) a non-negative,
+ * integer valued field dist, used as the key.
+ *
+ * Keys must never be smaller than the last key extracted, and all keys in the
+ * queue must lie within maxWeight of each other (true for Dijkstra when
+ * maxWeight is the largest edge weight), so maxWeight+1 circular buckets hold
+ * every key. decreaseKey leaves the old entry behind; it is skipped when its
+ * bucket is reached.
+*/
+
+template <class T>
+class BucketQueue {
+    std::vector<std::vector<std::pair<unsigned, T *>>> buckets;
+    unsigned current = UINT_MAX;    // key of the bucket being scanned
+    size_t count = 0;       // entries, including the outdated ones
+    bool advance();
+public:
+    explicit BucketQueue(unsigned maxWeight = 0);
+    void setMaxWeight(unsigned maxWeight);
+    void insert(T * x);
+    T * extractMin();
+    T * top();
+    void decreaseKey(T * x);
+    bool empty();
+    void clear();
+};
+
+template <class T>
+BucketQueue<T>::BucketQueue(unsigned maxWeight) : buckets(maxWeight + 1) {
+}
+
+template <class T>
+void BucketQueue<T>::setMaxWeight(unsigned maxWeight) {
+    if (buckets.size() != maxWeight + 1) {
+        clear();
+        buckets.resize(maxWeight + 1);
+    }
+}
+
+/*
+ * Moves current to the bucket of the smallest live entry, dropping the
+ * outdated ones on the way. Returns false if there is none.
+ */
+template <class T>
+bool BucketQueue<T>::advance() {
+    while (count > 0) {
+        auto &bucket = buckets[current % buckets.size()];
+        while (!bucket.empty()) {
+            auto [key, x] = bucket.back();
+            if (x->queueIndex != 0 && key == (unsigned) x->dist)
+                return true;
+            bucket.pop_back();
+            count--;
+        }
+        current++;
+    }
+    return false;
+}
+
+template <class T>
+bool BucketQueue<T>::empty() {
+    return !advance();
+}
+
+template <class T>
+void BucketQueue<T>::clear() {
+    if (count > 0)
+        for (auto &bucket : buckets) bucket.clear();
+    count = 0;
+    current = UINT_MAX;
+}
+
+template <class T>
+T* BucketQueue<T>::extractMin() {
+    advance();
+    auto &bucket = buckets[current % buckets.size()];
+    T *x = bucket.back().second;
+    bucket.pop_back();
+    count--;
+    x->queueIndex = 0;
+    return x;
+}
+
+template <class T>
+T* BucketQueue<T>::top() {
+    advance();
+    return buckets[current % buckets.size()].back().second;
+}
+
+template <class T>
+void BucketQueue<T>::insert(T *x) {
+    unsigned key = x->dist;
+    if (key < current) current = key;   // only before the first extraction
+    buckets[key % buckets.size()].emplace_back(key, x);
+    count++;
+    x->queueIndex = 1;
+}
+
+template <class T>
+void BucketQueue<T>::decreaseKey(T *x) {
+    insert(x);
+}
+
+#endif /* DA_TP_CLASSES_BUCKETQUEUE */
@@ -0,0 +1,355 @@
+#include "ContractionHierarchy.h"
+#include <queue>
+#include <climits>
+#include <algorithm>
+#include <functional>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include "../AtomicFile.h"
+#include "../CsrGraph.h"
+
+using namespace std;
+
+namespace {
+    using Arc = ContractionHierarchy::Arc;
+
+    const char MAGIC[4] = {'R', 'P', 'C', 'H'};
+    const uint32_t VERSION = 1;
+
+    // Witness searches give up after settling this many nodes; a witness that is
+    // not found only costs an unnecessary shortcut
+    const int WITNESS_SETTLE_LIMIT = 500;
+
+    /*
+     * Adds an arc to node, or lowers the weight of the existing one.
+     */
+    void addArc(vector<Arc>& arcs, int node, int weight, int middle) {
+        for (auto& arc : arcs) {
+            if (arc.node == node) {
+                if (weight < arc.weight) {
+                    arc.weight = weight;
+                    arc.middle = middle;
+                }
+                return;
+            }
+        }
+        arcs.push_back({node, weight, middle});
+    }
+
+    void removeArc(vector<Arc>& arcs, int node) {
+        arcs.erase(remove_if(arcs.begin(), arcs.end(), [&](const Arc& arc) { return arc.node == node; }),
+                   arcs.end());
+    }
+
+    /*
+     * The remaining (not yet contracted) graph while the hierarchy is built.
+     */
+    struct Contractor {
+        vector<vector<Arc>> out, in;
+        vector<int> contractedNeighbours;
+        vector<int> dist;           // witness search distances, INT_MAX when untouched
+        vector<int> touched;
+
+        explicit Contractor(int n) : out(n), in(n), contractedNeighbours(n, 0), dist(n, INT_MAX) {}
+
+        /*
+         * Bounded Dijkstra from source over the remaining graph without skip;
+         * leaves the distances found in dist.
+         */
+        void witnessSearch(int source, int skip, int limit) {
+            for (int v : touched) dist[v] = INT_MAX;
+            touched.clear();
+
+            priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
+            dist[source] = 0;
+            touched.push_back(source);
+            pq.emplace(0, source);
+            int settled = 0;
+
+            while (!pq.empty()) {
+                auto [d, u] = pq.top();
+                pq.pop();
+                if (d > dist[u]) continue;
+                if (d > limit || ++settled > WITNESS_SETTLE_LIMIT) break;
+
+                for (const Arc& arc : out[u]) {
+                    if (arc.node == skip) continue;
+                    int newDist = d + arc.weight;
+                    if (newDist < dist[arc.node]) {
+                        if (dist[arc.node] == INT_MAX) touched.push_back(arc.node);
+                        dist[arc.node] = newDist;
+                        pq.emplace(newDist, arc.node);
+                    }
+                }
+            }
+        }
+
+        /*
+         * Shortcuts needed to contract v; they are only added when simulate is false.
+         */
+        int contract(int v, bool simulate) {
+            int maxOut = 0;
+            for (const Arc& arc : out[v]) maxOut = max(maxOut, arc.weight);
+
+            int shortcuts = 0;
+            for (const Arc& inArc : in[v]) {
+                int u = inArc.node;
+                witnessSearch(u, v, inArc.weight + maxOut);
+                for (const Arc& outArc : out[v]) {
+                    int x = outArc.node;
+                    int viaV = inArc.weight + outArc.weight;
+                    if (x == u || dist[x] <= viaV) continue;
+                    shortcuts++;
+                    if (!simulate) {
+                        addArc(out[u], x, viaV, v);
+                        addArc(in[x], u, viaV, v);
+                    }
+                }
+            }
+            return shortcuts;
+        }
+
+        int priority(int v) {
+            return contract(v, true) - (int) in[v].size() - (int) out[v].size() + contractedNeighbours[v];
+        }
+    };
+}
+
+ContractionHierarchy::ContractionHierarchy(const Graph<int>& graph)
+    : ContractionHierarchy(CsrGraph<int>(graph)) {}
+
+ContractionHierarchy::ContractionHierarchy(const CsrGraph<int>& network) {
+    fingerprint = network.getFingerprint();
+    int n = network.getNumVertex();
+
+    Contractor remaining(n);
+    for (int e = 0; e < network.getNumEdges(); e++) {
+        int u = network.getOrig(e), x = network.getDest(e);
+        if (network.getWeight(e) < 0 || u == x) continue;
+        addArc(remaining.out[u], x, network.getWeight(e), -1);
+        addArc(remaining.in[x], u, network.getWeight(e), -1);
+    }
+
+    // Least important first, with lazy updates: a node whose priority got
+    // worse since it was queued goes back in the queue
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> order;
+    for (int v = 0; v < n; v++) order.emplace(remaining.priority(v), v);
+
+    vector<vector<Arc>> up(n), down(n);
+    rank.assign(n, -1);
+    int next = 0;
+    while (!order.empty()) {
+        int v = order.top().second;
+        order.pop();
+        int current = remaining.priority(v);
+        if (!order.empty() && current > order.top().first) {
+            order.emplace(current, v);
+            continue;
+        }
+
+        rank[v] = next++;
+        remaining.contract(v, false);
+        up[v] = remaining.out[v];
+        down[v] = remaining.in[v];
+        for (const Arc& arc : up[v]) {
+            removeArc(remaining.in[arc.node], v);
+            remaining.contractedNeighbours[arc.node]++;
+        }
+        for (const Arc& arc : down[v]) {
+            removeArc(remaining.out[arc.node], v);
+            remaining.contractedNeighbours[arc.node]++;
+        }
+    }
+
+    auto flatten = [n](const vector<vector<Arc>>& lists, vector<int>& offsets, vector<Arc>& arcs) {
+        offsets.assign(1, 0);
+        for (int v = 0; v < n; v++) {
+            arcs.insert(arcs.end(), lists[v].begin(), lists[v].end());
+            offsets.push_back(arcs.size());
+        }
+    };
+    flatten(up, upOffsets, upArcs);
+    flatten(down, downOffsets, downArcs);
+
+    for (const Arc& arc : upArcs) numShortcuts += arc.middle != -1;
+    for (const Arc& arc : downArcs) numShortcuts += arc.middle != -1;
+}
+
+bool ContractionHierarchy::query(SearchContext& context, int source, int target,
+                                 vector<int>& path, int& total_time) const {
+    int n = getNumVertex();
+    context.reset(2 * n);
+    auto& pq = context.queue();
+
+    // Forward search at [0, n), backward search at [n, 2n), in one queue:
+    // once its closest node is no nearer than the best meeting, both are done
+    context[source].dist = 0;
+    pq.insert(&context[source]);
+    context[n + target].dist = 0;
+    pq.insert(&context[n + target]);
+
+    int best = SearchContext::UNREACHABLE;
+    int meet = -1;
+
+    while (!pq.empty() && pq.top()->dist < best) {
+        SearchContext::Node* current = pq.extractMin();
+        current->visited = true;
+        context.countSettled();
+
+        int i = context.indexOf(current);
+        bool backward = i >= n;
+        int u = backward ? i - n : i;
+        int side = backward ? n : 0;
+
+        int otherDist = context[backward ? u : n + u].dist;
+        if (otherDist != SearchContext::UNREACHABLE && current->dist + otherDist < best) {
+            best = current->dist + otherDist;
+            meet = u;
+        }
+
+        // Stall-on-demand: if a more important node already labelled reaches u
+        // more quickly, u is not on a shortest path and is not expanded
+        const vector<int>& stallOffsets = backward ? upOffsets : downOffsets;
+        const vector<Arc>& stallArcs = backward ? upArcs : downArcs;
+        bool stalled = false;
+        for (int a = stallOffsets[u]; a < stallOffsets[u + 1] && !stalled; a++) {
+            int dist = context[side + stallArcs[a].node].dist;
+            stalled = dist != SearchContext::UNREACHABLE && dist + stallArcs[a].weight < current->dist;
+        }
+        if (stalled) continue;
+
+        const vector<int>& offsets = backward ? downOffsets : upOffsets;
+        const vector<Arc>& arcs = backward ? downArcs : upArcs;
+        for (int a = offsets[u]; a < offsets[u + 1]; a++) {
+            SearchContext::Node& neighbor = context[side + arcs[a].node];
+            int newDist = current->dist + arcs[a].weight;
+            if (!neighbor.visited && newDist < neighbor.dist) {
+                neighbor.dist = newDist;
+                neighbor.path = u;
+                if (neighbor.queueIndex == 0) {
+                    pq.insert(&neighbor);
+                } else {
+                    pq.decreaseKey(&neighbor);
+                }
+            }
+        }
+    }
+
+    if (meet == -1) return false;
+
+    // Nodes of the upward paths, source -> meet -> target
+    vector<int> hierarchyPath;
+    for (int v = meet; v != -1; v = context[v].path) hierarchyPath.push_back(v);
+    reverse(hierarchyPath.begin(), hierarchyPath.end());
+    for (int v = context[n + meet].path; v != -1; v = context[n + v].path) hierarchyPath.push_back(v);
+
+    total_time = best;
+    path.assign(1, source);
+    for (size_t k = 0; k + 1 < hierarchyPath.size(); k++) {
+        unpack(hierarchyPath[k], hierarchyPath[k + 1], path);
+    }
+    return true;
+}
+
+const ContractionHierarchy::Arc* ContractionHierarchy::findArc(int from, int to) const {
+    // the arc is stored at its less important end
+    if (rank[from] < rank[to]) {
+        for (int a = upOffsets[from]; a < upOffsets[from + 1]; a++) {
+            if (upArcs[a].node == to) return &upArcs[a];
+        }
+    } else {
+        for (int a = downOffsets[to]; a < downOffsets[to + 1]; a++) {
+            if (downArcs[a].node == from) return &downArcs[a];
+        }
+    }
+    return nullptr;
+}
+
+/*
+ * Appends the original nodes of the arc from -> to, without from itself.
+ */
+void ContractionHierarchy::unpack(int from, int to, vector<int>& path) const {
+    const Arc* arc = findArc(from, to);
+    if (arc->middle == -1) {
+        path.push_back(to);
+        return;
+    }
+    unpack(from, arc->middle, path);
+    unpack(arc->middle, to, path);
+}
+
+namespace {
+    template <class V>
+    void writeVector(ofstream& out, const vector<V>& v) {
+        out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(V));
+    }
+
+    template <class V>
+    void readVector(ifstream& in, vector<V>& v, size_t count) {
+        v.resize(count);
+        in.read(reinterpret_cast<char*>(v.data()), count * sizeof(V));
+    }
+
+    /*
+     * Whether the arcs listed by offsets (n + 1 entries) are all there and
+     * point to nodes.
+     */
+    bool validArcs(const vector<int>& offsets, const vector<Arc>& arcs, int n) {
+        if (offsets[0] != 0 || offsets[n] != (int) arcs.size()) return false;
+        for (int v = 0; v < n; v++) {
+            if (offsets[v] > offsets[v + 1]) return false;
+        }
+        return all_of(arcs.begin(), arcs.end(), [n](const Arc& a) { return a.node >= 0 && a.node < n && a.middle < n; });
+    }
+}
+
+void ContractionHierarchy::save(const string& filename) const {
+    AtomicFile::write(filename, [&](ofstream& out) {
+        int32_t header[4] = {getNumVertex(), (int32_t) upArcs.size(), (int32_t) downArcs.size(), numShortcuts};
+        out.write(MAGIC, sizeof(MAGIC));
+        out.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+        writeVector(out, rank);
+        writeVector(out, upOffsets);
+        writeVector(out, upArcs);
+        writeVector(out, downOffsets);
+        writeVector(out, downArcs);
+    });
+}
+
+ContractionHierarchy ContractionHierarchy::load(const string& filename, const CsrGraph<int>& network) {
+    ifstream in(filename, ios::binary);
+    if (!in.is_open()) throw runtime_error("ERRO: Não foi possível abrir " + filename);
+
+    char magic[4];
+    uint32_t version;
+    int32_t header[4];
+    ContractionHierarchy hierarchy;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    in.read(reinterpret_cast<char*>(&hierarchy.fingerprint), sizeof(hierarchy.fingerprint));
+    if (!in || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION
+        || header[1] < 0 || header[2] < 0) {
+        throw runtime_error("ERRO: Formato inválido em " + filename);
+    }
+
+    int n = header[0];
+    if (n != network.getNumVertex() || hierarchy.fingerprint != network.getFingerprint()) {
+        throw runtime_error("ERRO: " + filename + " não corresponde à rede carregada");
+    }
+    hierarchy.numShortcuts = header[3];
+    readVector(in, hierarchy.rank, n);
+    readVector(in, hierarchy.upOffsets, n + 1);
+    readVector(in, hierarchy.upArcs, header[1]);
+    readVector(in, hierarchy.downOffsets, n + 1);
+    readVector(in, hierarchy.downArcs, header[2]);
+    if (!in) throw runtime_error("ERRO: Ficheiro truncado: " + filename);
+
+    if (!validArcs(hierarchy.upOffsets, hierarchy.upArcs, n) || !validArcs(hierarchy.downOffsets, hierarchy.downArcs, n)) {
+        throw runtime_error("ERRO: Formato inválido em " + filename);
+    }
+    return hierarchy;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file ContractionHierarchy.h
+ * @brief Contraction Hierarchies (CH) for fast driving queries
+ */
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "../Graph.h"
+#include "../CsrGraph.h"
+#include "../RouteFinder/SearchContext.h"
+
+/**
+ * @class ContractionHierarchy
+ * @brief Driving network preprocessed into a hierarchy of shortcuts
+ *
+ * Nodes are contracted one by one, least important first (by edge difference:
+ * shortcuts added minus edges removed). Contracting v adds a shortcut u->x for
+ * every pair of neighbours whose shortest path goes through v, so after all
+ * nodes are contracted any shortest path can be found by searching upwards
+ * (towards more important nodes) from both ends.
+ *
+ * Only drivable edges are used. Nodes are numbered by the dense indices of a
+ * CsrGraph built from the same Graph (or the CsrGraph it was built from).
+ */
+class ContractionHierarchy {
+public:
+    ContractionHierarchy() = default;
+
+    /**
+     * @brief Orders the nodes and adds the shortcuts
+     * @param graph Road network as loaded by FileParser::loadGraph
+     */
+    explicit ContractionHierarchy(const Graph<int>& graph);
+
+    /**
+     * @brief Orders the nodes and adds the shortcuts
+     * @param network CSR network of the roads (e.g. from a GraphSnapshot)
+     */
+    explicit ContractionHierarchy(const CsrGraph<int>& network);
+
+    /**
+     * @brief Writes the hierarchy to a binary file
+     * @throw runtime_error If the file cannot be written
+     * @note Written under a temporary name and renamed over filename (see AtomicFile)
+     */
+    void save(const std::string& filename) const;
+
+    /**
+     * @brief Reads a hierarchy written by save
+     * @param network Network the hierarchy must have been built from
+     * @throw runtime_error If the file cannot be read, is damaged or was built
+     *        for another network (see CsrGraph::getFingerprint)
+     */
+    static ContractionHierarchy load(const std::string& filename, const CsrGraph<int>& network);
+
+    int getNumVertex() const { return rank.size(); }
+    int getNumShortcuts() const { return numShortcuts; }
+
+    /**
+     * @brief Fastest driving route between two nodes
+     *
+     * Bidirectional upward search with stall-on-demand; both directions share
+     * context, the backward one at indices getNumVertex() and above.
+     *
+     * @param source Dense index of the starting node
+     * @param target Dense index of the destination node
+     * @param[out] path Dense indices of every node of the route, shortcuts unpacked
+     * @param[out] total_time Driving time of the route
+     * @return true if target can be reached from source
+     */
+    bool query(SearchContext& context, int source, int target,
+               std::vector<int>& path, int& total_time) const;
+
+    /**
+     * @brief Edge of the hierarchy, stored at its less important end
+     */
+    struct Arc {
+        int node;       // other end
+        int weight;
+        int middle;     // contracted node the shortcut skips, -1 for an original edge
+    };
+
+private:
+    std::vector<int> rank;              // contraction order of every node
+    std::vector<int> upOffsets;         // N+1 entries
+    std::vector<Arc> upArcs;            // v -> node, rank[node] > rank[v]
+    std::vector<int> downOffsets;       // N+1 entries
+    std::vector<Arc> downArcs;          // node -> v, rank[node] > rank[v]
+    int numShortcuts = 0;
+    uint64_t fingerprint = 0;           // of the network it was built from
+
+    const Arc* findArc(int from, int to) const;
+    void unpack(int from, int to, std::vector<int>& path) const;
+};
+
+#endif // CONTRACTION_HIERARCHY_H
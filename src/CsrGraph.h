@@ -0,0 +1,279 @@
+/**
+ * @file CsrGraph.h
+ * @brief Immutable compressed-sparse-row (CSR) view of a Graph
+ *
+ * Vertices are renumbered to dense indices 0..N-1 (in vertexSet order) and
+ * the outgoing edges of every vertex are stored contiguously, so a search
+ * walks flat arrays instead of chasing Vertex/Edge pointers. A second set of
+ * offsets lists the incoming edges of every vertex for backward searches.
+ * W is the weight type, as in Graph.
+ *
+ * The arrays are only read through pointers, so a CsrGraph is either built
+ * from a Graph (and owns them) or a view of arrays kept elsewhere, e.g. a
+ * memory-mapped GraphSnapshot. Copies share the same arrays.
+ */
+
+#ifndef DA_TP_CLASSES_CSRGRAPH
+#define DA_TP_CLASSES_CSRGRAPH
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include "Graph.h"
+
+/************************* CsrGraph  **************************/
+
+template <class T, class W = int>
+class CsrGraph {
+public:
+    /*
+     * The flat arrays of the graph. T and W must be trivially copyable for
+     * them to be written to (and mapped from) a file.
+     */
+    struct Arrays {
+        int numVertex = 0, numEdges = 0;
+        W maxWeight = 0;                        // over the drivable edges
+        W maxWalkingWeight = 0;
+        const T *info = nullptr;                // N entries: dense index -> vertex content
+        const int *sortedByInfo = nullptr;      // N entries: dense indices by increasing content
+        const int *offsets = nullptr;           // N+1 entries
+        const int *sources = nullptr;           // E entries
+        const int *targets = nullptr;           // E entries
+        const W *weights = nullptr;             // E entries
+        const W *walkingWeights = nullptr;      // E entries
+        const int *incomingOffsets = nullptr;   // N+1 entries
+        const int *incomingEdges = nullptr;     // E entries, grouped by destination
+    };
+
+    CsrGraph() = default;
+    /*
+     * Builds the CSR arrays from a graph. Edge order inside each vertex is
+     * the same as in the vertex adjacency list.
+     */
+    explicit CsrGraph(const Graph<T, W> &graph);
+    /*
+     * View of arrays owned by someone else; owner is kept alive by the graph
+     * and its copies.
+     */
+    CsrGraph(const Arrays &arrays, std::shared_ptr<const void> owner);
+
+    int getNumVertex() const;
+    int getNumEdges() const;
+
+    /*
+     * Returns the dense index of the vertex with a given content, or -1.
+     */
+    int findVertexIdx(const T &in) const;
+    const T &getInfo(int v) const;
+
+    /*
+     * Outgoing edges of v are the edge indices in [edgesBegin(v), edgesEnd(v)).
+     */
+    int edgesBegin(int v) const;
+    int edgesEnd(int v) const;
+
+    /*
+     * Incoming edges of v are listed at positions [incomingBegin(v), incomingEnd(v));
+     * getIncomingEdge maps a position to the index of the edge itself.
+     */
+    int incomingBegin(int v) const;
+    int incomingEnd(int v) const;
+    int getIncomingEdge(int i) const;
+
+    int getOrig(int e) const;
+    int getDest(int e) const;
+    W getWeight(int e) const;               // driving weight, negative if not drivable
+    W getWalkingWeight(int e) const;
+    W getMaxWeight() const;                 // over the drivable edges
+    W getMaxWalkingWeight() const;
+
+    const Arrays &getArrays() const { return arrays; }
+
+    /*
+     * Hash (FNV-1a) of the vertex contents, edges and both weights, to tell
+     * whether data precomputed for a network (and saved to a file) still
+     * belongs to it. O(N + E).
+     */
+    uint64_t getFingerprint() const;
+
+protected:
+    /*
+     * Arrays of a graph built from a Graph.
+     */
+    struct Storage {
+        std::vector<T> info;
+        std::vector<int> sortedByInfo, offsets, sources, targets;
+        std::vector<W> weights, walkingWeights;
+        std::vector<int> incomingOffsets, incomingEdges;
+    };
+
+    Arrays arrays;
+    std::shared_ptr<const void> owner;      // memory behind the arrays
+};
+
+template <class T, class W>
+CsrGraph<T, W>::CsrGraph(const Graph<T, W> &graph) {
+    auto storage = std::make_shared<Storage>();
+    const auto &vertexSet = graph.getVertexSet();
+    int n = vertexSet.size();
+
+    std::unordered_map<T, int> index;       // vertex content -> dense index
+    storage->info.reserve(n);
+    index.reserve(n);
+    for (int i = 0; i < n; i++) {
+        storage->info.push_back(vertexSet[i]->getInfo());
+        index[vertexSet[i]->getInfo()] = i;
+    }
+
+    storage->offsets.reserve(n + 1);
+    storage->offsets.push_back(0);
+    for (auto v : vertexSet) {
+        for (auto e : v->getAdj()) {
+            storage->sources.push_back(storage->offsets.size() - 1);
+            storage->targets.push_back(index.at(e->getDest()->getInfo()));
+            storage->weights.push_back(e->getWeight());
+            storage->walkingWeights.push_back(e->getWalkingWeight());
+            arrays.maxWeight = std::max(arrays.maxWeight, e->getWeight());
+            arrays.maxWalkingWeight = std::max(arrays.maxWalkingWeight, e->getWalkingWeight());
+        }
+        storage->offsets.push_back(storage->targets.size());
+    }
+
+    storage->sortedByInfo.resize(n);
+    for (int i = 0; i < n; i++)
+        storage->sortedByInfo[i] = i;
+    std::sort(storage->sortedByInfo.begin(), storage->sortedByInfo.end(),
+              [&](int a, int b) { return storage->info[a] < storage->info[b]; });
+
+    // counting sort of the edges by destination, keeping edge order
+    int m = storage->targets.size();
+    storage->incomingOffsets.assign(n + 1, 0);
+    for (int e = 0; e < m; e++)
+        storage->incomingOffsets[storage->targets[e] + 1]++;
+    for (int v = 0; v < n; v++)
+        storage->incomingOffsets[v + 1] += storage->incomingOffsets[v];
+    storage->incomingEdges.resize(m);
+    std::vector<int> next(storage->incomingOffsets.begin(), storage->incomingOffsets.end() - 1);
+    for (int e = 0; e < m; e++)
+        storage->incomingEdges[next[storage->targets[e]]++] = e;
+
+    arrays.numVertex = n;
+    arrays.numEdges = m;
+    arrays.info = storage->info.data();
+    arrays.sortedByInfo = storage->sortedByInfo.data();
+    arrays.offsets = storage->offsets.data();
+    arrays.sources = storage->sources.data();
+    arrays.targets = storage->targets.data();
+    arrays.weights = storage->weights.data();
+    arrays.walkingWeights = storage->walkingWeights.data();
+    arrays.incomingOffsets = storage->incomingOffsets.data();
+    arrays.incomingEdges = storage->incomingEdges.data();
+    owner = storage;
+}
+
+template <class T, class W>
+CsrGraph<T, W>::CsrGraph(const Arrays &arrays, std::shared_ptr<const void> owner)
+    : arrays(arrays), owner(std::move(owner)) {}
+
+template <class T, class W>
+int CsrGraph<T, W>::getNumVertex() const {
+    return arrays.numVertex;
+}
+
+template <class T, class W>
+int CsrGraph<T, W>::getNumEdges() const {
+    return arrays.numEdges;
+}
+
+template <class T, class W>
+int CsrGraph<T, W>::findVertexIdx(const T &in) const {
+    const int *first = arrays.sortedByInfo, *last = first + arrays.numVertex;
+    const int *it = std::lower_bound(first, last, in, [&](int v, const T &value) { return arrays.info[v] < value; });
+    return it != last && arrays.info[*it] == in ? *it : -1;
+}
+
+template <class T, class W>
+const T &CsrGraph<T, W>::getInfo(int v) const {
+    return arrays.info[v];
+}
+
+template <class T, class W>
+int CsrGraph<T, W>::edgesBegin(int v) const {
+    return arrays.offsets[v];
+}
+
+template <class T, class W>
+int CsrGraph<T, W>::edgesEnd(int v) const {
+    return arrays.offsets[v + 1];
+}
+
+template <class T, class W>
+int CsrGraph<T, W>::incomingBegin(int v) const {
+    return arrays.incomingOffsets[v];
+}
+
+template <class T, class W>
+int CsrGraph<T, W>::incomingEnd(int v) const {
+    return arrays.incomingOffsets[v + 1];
+}
+
+template <class T, class W>
+int CsrGraph<T, W>::getIncomingEdge(int i) const {
+    return arrays.incomingEdges[i];
+}
+
+template <class T, class W>
+int CsrGraph<T, W>::getOrig(int e) const {
+    return arrays.sources[e];
+}
+
+template <class T, class W>
+int CsrGraph<T, W>::getDest(int e) const {
+    return arrays.targets[e];
+}
+
+template <class T, class W>
+W CsrGraph<T, W>::getWeight(int e) const {
+    return arrays.weights[e];
+}
+
+template <class T, class W>
+W CsrGraph<T, W>::getWalkingWeight(int e) const {
+    return arrays.walkingWeights[e];
+}
+
+template <class T, class W>
+W CsrGraph<T, W>::getMaxWeight() const {
+    return arrays.maxWeight;
+}
+
+template <class T, class W>
+W CsrGraph<T, W>::getMaxWalkingWeight() const {
+    return arrays.maxWalkingWeight;
+}
+
+template <class T, class W>
+uint64_t CsrGraph<T, W>::getFingerprint() const {
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&](const void *data, size_t bytes) {
+        if (data == nullptr) return;
+        const unsigned char *p = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < bytes; i++) {
+            hash ^= p[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    size_t n = arrays.numVertex, m = arrays.numEdges;
+    add(&arrays.numVertex, sizeof(int));
+    add(&arrays.numEdges, sizeof(int));
+    add(arrays.info, n * sizeof(T));
+    add(arrays.offsets, (n + 1) * sizeof(int));
+    add(arrays.targets, m * sizeof(int));
+    add(arrays.weights, m * sizeof(W));
+    add(arrays.walkingWeights, m * sizeof(W));
+    return hash;
+}
+
+#endif /* DA_TP_CLASSES_CSRGRAPH */
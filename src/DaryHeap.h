@@ -0,0 +1,177 @@
+/*
+ * DaryHeap.h
+ * d-ary heap keeping the keys next to the item indices, for the Dijkstra searches.
+ */
+
+#ifndef DA_TP_CLASSES_DARYHEAP
+#define DA_TP_CLASSES_DARYHEAP
+
+#include <vector>
+#include <algorithm>
+
+/**
+ * class T must have: (i) accessible field int queueIndex; (ii) a field dist,
+ * used as the key and stored with its own type (the weight type W of a
+ * BasicSearchContext<W>). The items live in one array (see
+ * setItems) and the heap stores (key, index in that array) pairs, so
+ * comparisons never leave the heap.
+ *
+ * The D children of a node are contiguous and aligned to D entries (one
+ * cache line with D = 8). The root is at position D-1, leaving the first
+ * D-1 slots unused, so that the children of p start at D * (p - D + 2).
+ *
+ * With Lazy, decreaseKey inserts the item again instead of moving it; the
+ * outdated entries are dropped when they reach the top.
+*/
+
+template <class T, unsigned D = 4, bool Lazy = false>
+class DaryHeap {
+    static_assert(D >= 2, "a heap node needs at least two children");
+
+    using Key = decltype(T::dist);
+
+    struct Entry {
+        Key key;
+        int index;
+    };
+    struct alignas(sizeof(Entry) * D) Line {
+        Entry entries[D];
+    };
+
+    static const unsigned ROOT = D - 1;
+
+    std::vector<Line> lines;
+    unsigned size = ROOT;   // first free position
+    T * items = nullptr;
+
+    Entry &at(unsigned p) { return lines[p / D].entries[p % D]; }
+    static unsigned parentOf(unsigned p) { return p / D + D - 2; }
+    static unsigned firstChildOf(unsigned p) { return D * (p - D + 2); }
+    inline void place(unsigned p, const Entry &e);
+    void heapifyUp(unsigned p);
+    void heapifyDown(unsigned p);
+    void removeTop();
+    bool isOutdated(const Entry &e) const;
+    void dropOutdated();
+public:
+    DaryHeap() = default;
+    /**
+     * @brief Array the indices refer to; must be set again if it moves
+     */
+    void setItems(T * items);
+    void insert(T * x);
+    T * extractMin();
+    T * top();
+    void decreaseKey(T * x);
+    bool empty();
+    void clear();
+};
+
+template <class T, unsigned D, bool Lazy>
+void DaryHeap<T, D, Lazy>::setItems(T *items) {
+    this->items = items;
+}
+
+template <class T, unsigned D, bool Lazy>
+void DaryHeap<T, D, Lazy>::place(unsigned p, const Entry &e) {
+    at(p) = e;
+    if (!Lazy) items[e.index].queueIndex = p;
+}
+
+template <class T, unsigned D, bool Lazy>
+bool DaryHeap<T, D, Lazy>::isOutdated(const Entry &e) const {
+    return Lazy && (items[e.index].queueIndex == 0 || e.key != items[e.index].dist);
+}
+
+template <class T, unsigned D, bool Lazy>
+void DaryHeap<T, D, Lazy>::dropOutdated() {
+    while (size > ROOT && isOutdated(at(ROOT)))
+        removeTop();
+}
+
+template <class T, unsigned D, bool Lazy>
+bool DaryHeap<T, D, Lazy>::empty() {
+    dropOutdated();
+    return size == ROOT;
+}
+
+template <class T, unsigned D, bool Lazy>
+void DaryHeap<T, D, Lazy>::clear() {
+    size = ROOT;
+}
+
+template <class T, unsigned D, bool Lazy>
+void DaryHeap<T, D, Lazy>::removeTop() {
+    size--;
+    if (size > ROOT) {
+        at(ROOT) = at(size);
+        heapifyDown(ROOT);
+    }
+}
+
+template <class T, unsigned D, bool Lazy>
+T* DaryHeap<T, D, Lazy>::extractMin() {
+    dropOutdated();
+    T *x = &items[at(ROOT).index];
+    removeTop();
+    x->queueIndex = 0;
+    return x;
+}
+
+template <class T, unsigned D, bool Lazy>
+T* DaryHeap<T, D, Lazy>::top() {
+    dropOutdated();
+    return &items[at(ROOT).index];
+}
+
+template <class T, unsigned D, bool Lazy>
+void DaryHeap<T, D, Lazy>::insert(T *x) {
+    if (size / D >= lines.size())
+        lines.emplace_back();
+    at(size) = {x->dist, (int) (x - items)};
+    if (Lazy) x->queueIndex = 1;
+    heapifyUp(size++);
+}
+
+template <class T, unsigned D, bool Lazy>
+void DaryHeap<T, D, Lazy>::decreaseKey(T *x) {
+    if (Lazy) {
+        insert(x);
+        return;
+    }
+    at(x->queueIndex).key = x->dist;
+    heapifyUp(x->queueIndex);
+}
+
+template <class T, unsigned D, bool Lazy>
+void DaryHeap<T, D, Lazy>::heapifyUp(unsigned p) {
+    Entry e = at(p);
+    while (p > ROOT && e.key < at(parentOf(p)).key) {
+        place(p, at(parentOf(p)));
+        p = parentOf(p);
+    }
+    place(p, e);
+}
+
+template <class T, unsigned D, bool Lazy>
+void DaryHeap<T, D, Lazy>::heapifyDown(unsigned p) {
+    Entry e = at(p);
+    while (true) {
+        unsigned k = firstChildOf(p);
+        if (k >= size)
+            break;
+        Entry *children = &at(k);
+        unsigned count = std::min(D, size - k);
+        unsigned best = 0;
+        for (unsigned c = 1; c < count; c++)
+            if (children[c].key < children[best].key)
+                best = c; // smallest child of p
+        if (!(children[best].key < e.key))
+            break;
+        place(p, children[best]);
+        p = k + best;
+    }
+    place(p, e);
+}
+
+#endif /* DA_TP_CLASSES_DARYHEAP */
@@ -3,40 +3,106 @@
 #include <string>
 #include <vector>
 #include <algorithm>
-#include <sstream>
+#include <string_view>
+#include <charconv>
+#include <cctype>
 #include <unordered_map>
 #include "FileParser.h"
 #include "../Graph.h"
+#include "../GraphBuilder.h"
 
 using namespace std;
 
+namespace {
+    /*
+     * Reads the whole file in one go; the lines are then tokenized in place.
+     */
+    string readFile(const string& filename) {
+        ifstream file(filename, ios::binary);
+        if (!file.is_open()) throw runtime_error("ERRO: Não foi possível abrir " + filename);
+        file.seekg(0, ios::end);
+        string text(file.tellg(), '\0');
+        file.seekg(0);
+        file.read(text.data(), text.size());
+        return text;
+    }
+
+    /*
+     * Splits a buffer into lines like getline, without copying them. A '\r'
+     * before the '\n' is dropped, as a text-mode stream does on Windows.
+     */
+    class LineReader {
+    public:
+        explicit LineReader(string& text) : pos(text.data()), end(text.data() + text.size()) {}
+
+        bool next(char*& first, char*& last) {
+            if (pos == end) return false;
+            first = pos;
+            last = find(pos, end, '\n');
+            pos = last == end ? end : last + 1;
+            if (last != first && last[-1] == '\r') last--;
+            return true;
+        }
+
+    private:
+        char* pos;
+        char* end;
+    };
+
+    /*
+     * Parses the leading integer of s as stoi does: leading whitespace and a
+     * '+' are skipped, anything after the digits is ignored.
+     * @return false where stoi would throw (no digits or out of range)
+     */
+    bool parseInt(string_view s, int& value) {
+        size_t i = 0;
+        while (i < s.size() && isspace((unsigned char) s[i])) i++;
+        if (i + 1 < s.size() && s[i] == '+' && isdigit((unsigned char) s[i + 1])) i++;
+        auto result = from_chars(s.data() + i, s.data() + s.size(), value);
+        return result.ec == errc();
+    }
+}
+
 unordered_map<string, int> FileParser::loadLocationMappings(
     const string& filename, unordered_map<int, bool>& parkingData) {
 
     unordered_map<string, int> codeToId;
-    ifstream file(filename);
-    if (!file.is_open()) throw runtime_error("ERRO: Não foi possível abrir " + filename);
-    string line;
-    getline(file, line); // Skip header
-
-    while (getline(file, line)) {
-        stringstream ss(line);
-        vector<string> tokens;
-        string token;
-
-        while (getline(ss, token, ',')) tokens.push_back(token);
-
-        if (tokens.size() >= 4) {
-            try {
-                int id = stoi(tokens[1]);
-                string code = tokens[2];
-                bool isParking = (tokens[3] == "1");
-                codeToId[code] = id;
-                parkingData[id] = isParking;
-            } catch (...) {
-                throw runtime_error("ERRO: Formato inválido no arquivo de localizações: " + line);
+    string text = readFile(filename);
+    size_t lines = count(text.begin(), text.end(), '\n');
+    codeToId.reserve(lines);
+    parkingData.reserve(parkingData.size() + lines);
+
+    LineReader reader(text);
+    char *first, *last;
+    reader.next(first, last); // Skip header
+
+    while (reader.next(first, last)) {
+        string_view line(first, last - first);
+        // the first four comma-separated fields; like getline, a trailing comma adds no field
+        string_view tokens[4];
+        size_t numTokens = 0, pos = 0;
+        if (!line.empty()) {
+            while (numTokens < 4) {
+                size_t comma = line.find(',', pos);
+                if (comma == string_view::npos) {
+                    tokens[numTokens++] = line.substr(pos);
+                    break;
+                }
+                tokens[numTokens++] = line.substr(pos, comma - pos);
+                pos = comma + 1;
+                if (pos == line.size()) break;
             }
         }
+
+        if (numTokens >= 4) {
+            int id;
+            if (!parseInt(tokens[1], id)) {
+                throw runtime_error("ERRO: Formato inválido no arquivo de localizações: " + string(line));
+            }
+            bool isParking = (tokens[3] == "1");
+            codeToId[string(tokens[2])] = id;
+            parkingData[id] = isParking;
+        }
     }
     return codeToId;
 }
@@ -45,67 +111,58 @@ unordered_map<string, int> FileParser::loadLocationMappings(
 void FileParser::loadGraph(Graph<int>& roadNetwork, const string& filename,
                          const unordered_map<string, int>& codeToId) {
 
-    ifstream file(filename);
-    if (!file.is_open()) throw runtime_error("ERRO: Não foi possível abrir " + filename);
+    string text = readFile(filename);
+
+    // the codes are looked up as views of the line, so they need no string per lookup
+    unordered_map<string_view, int> idOfCode;
+    idOfCode.reserve(codeToId.size());
+    for (const auto& [code, id] : codeToId) idOfCode.emplace(code, id);
 
-    string line;
-    getline(file, line); // Skip header
+    GraphBuilder<int> builder(DuplicatePolicy::Last);
+    builder.reserve(count(text.begin(), text.end(), '\n'));
 
-    while (getline(file, line)) {
-        line.erase(remove(line.begin(), line.end(), ' '), line.end());
+    LineReader reader(text);
+    char *first, *last;
+    reader.next(first, last); // Skip header
+
+    while (reader.next(first, last)) {
+        last = remove(first, last, ' ');
+        string_view line(first, last - first);
         if (line.empty()) continue;
 
         size_t pos1 = line.find(',');
         size_t pos2 = line.find(',', pos1 + 1);
         size_t pos3 = line.find(',', pos2 + 1);
 
-        if (pos1 == string::npos || pos2 == string::npos || pos3 == string::npos) {
+        if (pos1 == string_view::npos || pos2 == string_view::npos || pos3 == string_view::npos) {
             cerr << "AVISO: Formato inválido - linha ignorada: " << line << endl;
             continue;
         }
 
-        string fromCode = line.substr(0, pos1);
-        string toCode = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        string drivingStr = line.substr(pos2 + 1, pos3 - pos2 - 1);
-        string walkingStr = line.substr(pos3 + 1);
+        string_view fromCode = line.substr(0, pos1);
+        string_view toCode = line.substr(pos1 + 1, pos2 - pos1 - 1);
+        string_view drivingStr = line.substr(pos2 + 1, pos3 - pos2 - 1);
+        string_view walkingStr = line.substr(pos3 + 1);
 
-        if (!codeToId.count(fromCode) || !codeToId.count(toCode)) {
+        auto from = idOfCode.find(fromCode);
+        auto to = idOfCode.find(toCode);
+        if (from == idOfCode.end() || to == idOfCode.end()) {
             cerr << "AVISO: Código não mapeado - linha ignorada: " << fromCode << " ou " << toCode << endl;
             continue;
         }
 
-        int fromId = codeToId.at(fromCode);
-        int toId = codeToId.at(toCode);
+        int fromId = from->second;
+        int toId = to->second;
         int driving, walking;
 
-        try {
-            driving = (drivingStr == "X") ? -1 : max(1, stoi(drivingStr));
-            walking = max(1, stoi(walkingStr));
-        } catch (...) {
+        if ((drivingStr != "X" && !parseInt(drivingStr, driving)) || !parseInt(walkingStr, walking)) {
             cerr << "AVISO: Valores inválidos - linha ignorada: " << line << endl;
             continue;
         }
+        driving = (drivingStr == "X") ? -1 : max(1, driving);
+        walking = max(1, walking);
 
-        roadNetwork.addVertex(fromId);
-        roadNetwork.addVertex(toId);
-
-        if (roadNetwork.addBidirectionalEdge(fromId, toId, driving)) {
-            Vertex<int>* fromVertex = roadNetwork.findVertex(fromId);
-            Vertex<int>* toVertex = roadNetwork.findVertex(toId);
-
-            if (fromVertex && toVertex) {
-                for (auto edge : fromVertex->getAdj()) {
-                    if (edge->getDest()->getInfo() == toId) {
-                        edge->setDrivable(driving > 0);
-                        edge->setWalkingWeight(walking);
-                        if (edge->getReverse()) {
-                            edge->getReverse()->setDrivable(driving > 0);
-                            edge->getReverse()->setWalkingWeight(walking);
-                        }
-                        break;
-                    }
-                }
-            }
-        }
+        builder.addRecord(fromId, toId, driving, walking);
     }
+    builder.build(roadNetwork);
 }
\ No newline at end of file
@@ -46,6 +46,8 @@ public:
  *
  * @note Expected CSV format: (columns) from_code,to_code,driving_time,walking_time
  * @note "X" in driving_time column indicates non-drivable segment
+ * @note Every segment is a bidirectional road; when a pair of locations is
+ *       listed more than once (in either order) the last line wins
  * @warning Header row is automatically skipped
  * @warning Invalid lines are skipped with warning messages
  */
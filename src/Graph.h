@@ -6,6 +6,12 @@
  * - Vertex: Representa um vértice/nó do grafo
  * - Edge: Representa uma aresta/conexão
  * - Graph: Classe principal do grafo
+ *
+ * W é o tipo dos pesos (int por omissão: tempos inteiros em minutos).
+ *
+ * Vértices e arestas vivem em arenas do grafo (ver Arena.h): são libertados
+ * todos de uma vez quando o último grafo que os partilha é destruído: cópias
+ * do grafo são snapshots copy-on-write (ver Graph::Graph(const Graph &)).
  */
 
 /**
@@ -21,29 +27,38 @@
 #include <queue>
 #include <limits>
 #include <algorithm>
+#include <unordered_map>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include "MutablePriorityQueue.h" // not needed for now
+#include "Arena.h"
 
-template <class T>
+template <class T, class W = int>
 class Edge;
 
-#define INF std::numeric_limits<double>::max()
+template <class T, class W>
+class Graph;
+
+template <class T, class W>
+class GraphBuilder;
 
 /************************* Vertex  **************************/
 
-template <class T>
+template <class T, class W = int>
 class Vertex {
 public:
-    Vertex(T in);
-    bool operator<(Vertex<T> & vertex) const; // // required by MutablePriorityQueue
+    Vertex(T in, Arena &edgeArena);
+    bool operator<(Vertex<T, W> & vertex) const; // // required by MutablePriorityQueue
 
     T getInfo() const;
-    std::vector<Edge<T> *> getAdj() const;
+    const std::vector<Edge<T, W> *> &getAdj() const;      // no copy: invalidated by adding/removing edges
     bool isVisited() const;
     bool isProcessing() const;
     unsigned int getIndegree() const;
-    double getDist() const;
-    Edge<T> *getPath() const;
-    std::vector<Edge<T> *> getIncoming() const;
+    W getDist() const;
+    Edge<T, W> *getPath() const;
+    const std::vector<Edge<T, W> *> &getIncoming() const; // no copy, as getAdj
 
     void setInfo(T info);
     void setVisited(bool visited);
@@ -55,82 +70,109 @@ public:
     void setNum(int value);
 
     void setIndegree(unsigned int indegree);
-    void setDist(double dist);
-    void setPath(Edge<T> *path);
-    Edge<T> * addEdge(Vertex<T> *dest, double w);
+    void setDist(W dist);
+    void setPath(Edge<T, W> *path);
+    Edge<T, W> * addEdge(Vertex<T, W> *dest, W w);
     bool removeEdge(T in);
     void removeOutgoingEdges();
 
     friend class MutablePriorityQueue<Vertex>;
+    friend class Graph<T, W>;
+    friend class GraphBuilder<T, W>;
 protected:
     T info;                // info node
-    std::vector<Edge<T> *> adj;  // outgoing edges
+    std::vector<Edge<T, W> *> adj;  // outgoing edges
 
     // auxiliary fields
     bool visited = false; // used by DFS, BFS, Prim ...
     bool processing = false; // used by isDAG (in addition to the visited attribute)
     int low = -1, num = -1; // used by SCC Tarjan
     unsigned int indegree; // used by topsort
-    double dist = 0;
-    Edge<T> *path = nullptr;
+    W dist = 0;
+    Edge<T, W> *path = nullptr;
 
-    std::vector<Edge<T> *> incoming; // incoming edges
+    std::vector<Edge<T, W> *> incoming; // incoming edges
 
     int queueIndex = 0; 		// required by MutablePriorityQueue and UFDS
 
-    void deleteEdge(Edge<T> *edge);
+    Arena *edgeArena;       // where the outgoing edges are allocated (owned by the graph)
+
+    void deleteEdge(Edge<T, W> *edge);
+    /*
+     * Constructs an outgoing edge in slot, memory allocated from edgeArena.
+     */
+    Edge<T, W> *placeEdge(Vertex<T, W> *dest, W w, Edge<T, W> *slot);
 };
 
 /********************** Edge  ****************************/
 
-template <class T>
+template <class T, class W>
 class Edge {
 public:
-    Edge(Vertex<T> *orig, Vertex<T> *dest, double w);
+    Edge(Vertex<T, W> *orig, Vertex<T, W> *dest, W w);
 
-    Vertex<T> * getDest() const;
-    double getWeight() const;
+    Vertex<T, W> * getDest() const;
+    W getWeight() const;
     bool isSelected() const;
-    Vertex<T> * getOrig() const;
-    Edge<T> *getReverse() const;
+    Vertex<T, W> * getOrig() const;
+    Edge<T, W> *getReverse() const;
     double getFlow() const;
     bool drivable;
 
     void setSelected(bool selected);
-    void setReverse(Edge<T> *reverse);
+    void setReverse(Edge<T, W> *reverse);
     void setFlow(double flow);
-    double getWalkingWeight() const;
-    void setWalkingWeight(double walkingWeight);
+    W getWalkingWeight() const;
+    void setWalkingWeight(W walkingWeight);
     void setDrivable(bool d) { drivable = d; }
     bool isDrivable() const { return drivable; }
-    void setWeight(double w) { weight = w; }
+    void setWeight(W w) { weight = w; }
 
 protected:
-    Vertex<T> * dest; // destination vertex
-    double weight; // edge weight, can also be used for capacity
+    Vertex<T, W> * dest; // destination vertex
+    W weight; // edge weight, can also be used for capacity
 
     // auxiliary fields
     bool selected = false;
 
     // used for bidirectional edges
-    Vertex<T> *orig;
-    Edge<T> *reverse = nullptr;
+    Vertex<T, W> *orig;
+    Edge<T, W> *reverse = nullptr;
 
     double flow; // for flow-related problems
 
-    double walkingWeight;
+    W walkingWeight;
+
+    friend class Graph<T, W>;
 };
 
 /********************** Graph  ****************************/
 
-template <class T>
+template <class T, class W = int>
 class Graph {
 public:
+    Graph() = default;
+    /*
+     * Copies are snapshots: O(1), sharing the vertices and edges with the
+     * original until either graph is modified. The first modification of a
+     * shared graph (adding/removing a vertex or an edge, or findMutableVertex)
+     * gives it its own deep copy, so changes never show through
+     * the other graphs. Vertex and Edge pointers taken from a graph before
+     * that point into the shared copy, not into the modified graph.
+     */
+    Graph(const Graph &other);
+    Graph &operator=(const Graph &other);
     ~Graph();
     /*
     * Auxiliary function to find a vertex with a given the content.
+    * A lookup only: never copies the vertices and edges of a shared graph.
+    */
+    const Vertex<T, W> *findVertex(const T &in) const;
+    /*
+    * The vertex with a given content, to be modified. If the graph is shared,
+    * first deep-copies every vertex and edge (O(V + E)), as any modification.
     */
-    Vertex<T> *findVertex(const T &in) const;
+    Vertex<T, W> *findMutableVertex(const T &in);
     /*
      *  Adds a vertex with a given content or info (in) to a graph (this).
      *  Returns true if successful, and false if a vertex with that content already exists.
@@ -143,25 +185,57 @@ public:
      * destination vertices and the edge weight (w).
      * Returns true if successful, and false if the source or destination vertex does not exist.
      */
-    bool addEdge(const T &sourc, const T &dest, double w);
+    bool addEdge(const T &sourc, const T &dest, W w);
     bool removeEdge(const T &source, const T &dest);
-    bool addBidirectionalEdge(const T &sourc, const T &dest, double w);
+    bool addBidirectionalEdge(const T &sourc, const T &dest, W w);
 
     int getNumVertex() const;
+    /*
+     * Bytes taken from the system for the vertices and edges (shared ones included).
+     */
+    size_t getMemoryReserved() const;
+    /*
+     * Whether the vertices and edges are shared with another graph.
+     */
+    bool isShared() const { return data.use_count() > 1; }
 
-    std::vector<Vertex<T> *> getVertexSet() const;
+    const std::vector<Vertex<T, W> *> &getVertexSet() const;
 
+    friend class GraphBuilder<T, W>;
 
 protected:
-    std::vector<Vertex<T> *> vertexSet;    // vertex set
+    /*
+     * Vertices, edges and the arenas they live in, shared between snapshots.
+     */
+    struct Data {
+        std::vector<Vertex<T, W> *> vertexSet;    // vertex set
+        std::unordered_map<T, int> vertexIndex;   // vertex content -> position in vertexSet
+        Arena vertexArena;                        // memory of every Vertex
+        Arena edgeArena;                          // memory of every Edge
+
+        Data() = default;
+        Data(const Data &other);                  // deep copy
+        Data &operator=(const Data &) = delete;
+        ~Data();
+    };
+
+    std::shared_ptr<Data> data = std::make_shared<Data>();
 
     double ** distMatrix = nullptr;   // dist matrix for Floyd-Warshall
     int **pathMatrix = nullptr;   // path matrix for Floyd-Warshall
 
+    /*
+     * The data of this graph only, deep-copied first if it is shared.
+     */
+    Data &mutableData();
     /*
      * Finds the index of the vertex with a given content.
      */
     int findVertexIdx(const T &in) const;
+    /*
+     * Constructs a vertex in the vertex arena, without adding it to vertexSet.
+     */
+    Vertex<T, W> *createVertex(Data &d, const T &in);
     /**
     * Auxiliary function to set the "path" field to make a spanning tree.
     */
@@ -174,15 +248,20 @@ void deleteMatrix(double **m, int n);
 
 /************************* Vertex  **************************/
 
-template <class T>
-Vertex<T>::Vertex(T in): info(in) {}
+template <class T, class W>
+Vertex<T, W>::Vertex(T in, Arena &edgeArena): info(in), edgeArena(&edgeArena) {}
 /*
  * Auxiliary function to add an outgoing edge to a vertex (this),
  * with a given destination vertex (d) and edge weight (w).
  */
-template <class T>
-Edge<T> * Vertex<T>::addEdge(Vertex<T> *d, double w) {
-    auto newEdge = new Edge<T>(this, d, w);
+template <class T, class W>
+Edge<T, W> * Vertex<T, W>::addEdge(Vertex<T, W> *d, W w) {
+    return placeEdge(d, w, edgeArena->allocate<Edge<T, W>>());
+}
+
+template <class T, class W>
+Edge<T, W> * Vertex<T, W>::placeEdge(Vertex<T, W> *d, W w, Edge<T, W> *slot) {
+    auto newEdge = new (slot) Edge<T, W>(this, d, w);
     adj.push_back(newEdge);
     d->incoming.push_back(newEdge);
     return newEdge;
@@ -193,13 +272,13 @@ Edge<T> * Vertex<T>::addEdge(Vertex<T> *d, double w) {
  * from a vertex (this).
  * Returns true if successful, and false if such edge does not exist.
  */
-template <class T>
-bool Vertex<T>::removeEdge(T in) {
+template <class T, class W>
+bool Vertex<T, W>::removeEdge(T in) {
     bool removedEdge = false;
     auto it = adj.begin();
     while (it != adj.end()) {
-        Edge<T> *edge = *it;
-        Vertex<T> *dest = edge->getDest();
+        Edge<T, W> *edge = *it;
+        Vertex<T, W> *dest = edge->getDest();
         if (dest->getInfo() == in) {
             it = adj.erase(it);
             deleteEdge(edge);
@@ -215,114 +294,114 @@ bool Vertex<T>::removeEdge(T in) {
 /*
  * Auxiliary function to remove an outgoing edge of a vertex.
  */
-template <class T>
-void Vertex<T>::removeOutgoingEdges() {
+template <class T, class W>
+void Vertex<T, W>::removeOutgoingEdges() {
     auto it = adj.begin();
     while (it != adj.end()) {
-        Edge<T> *edge = *it;
+        Edge<T, W> *edge = *it;
         it = adj.erase(it);
         deleteEdge(edge);
     }
 }
 
-template <class T>
-bool Vertex<T>::operator<(Vertex<T> & vertex) const {
+template <class T, class W>
+bool Vertex<T, W>::operator<(Vertex<T, W> & vertex) const {
     return this->dist < vertex.dist;
 }
 
-template <class T>
-T Vertex<T>::getInfo() const {
+template <class T, class W>
+T Vertex<T, W>::getInfo() const {
     return this->info;
 }
 
-template <class T>
-int Vertex<T>::getLow() const {
+template <class T, class W>
+int Vertex<T, W>::getLow() const {
     return this->low;
 }
 
-template <class T>
-void Vertex<T>::setLow(int value) {
+template <class T, class W>
+void Vertex<T, W>::setLow(int value) {
     this->low = value;
 }
 
-template <class T>
-int Vertex<T>::getNum() const {
+template <class T, class W>
+int Vertex<T, W>::getNum() const {
     return this->num;
 }
 
-template <class T>
-void Vertex<T>::setNum(int value) {
+template <class T, class W>
+void Vertex<T, W>::setNum(int value) {
     this->num = value;
 }
 
-template <class T>
-std::vector<Edge<T>*> Vertex<T>::getAdj() const {
+template <class T, class W>
+const std::vector<Edge<T, W>*> &Vertex<T, W>::getAdj() const {
     return this->adj;
 }
 
-template <class T>
-bool Vertex<T>::isVisited() const {
+template <class T, class W>
+bool Vertex<T, W>::isVisited() const {
     return this->visited;
 }
 
-template <class T>
-bool Vertex<T>::isProcessing() const {
+template <class T, class W>
+bool Vertex<T, W>::isProcessing() const {
     return this->processing;
 }
 
-template <class T>
-unsigned int Vertex<T>::getIndegree() const {
+template <class T, class W>
+unsigned int Vertex<T, W>::getIndegree() const {
     return this->indegree;
 }
 
-template <class T>
-double Vertex<T>::getDist() const {
+template <class T, class W>
+W Vertex<T, W>::getDist() const {
     return this->dist;
 }
 
-template <class T>
-Edge<T> *Vertex<T>::getPath() const {
+template <class T, class W>
+Edge<T, W> *Vertex<T, W>::getPath() const {
     return this->path;
 }
 
-template <class T>
-std::vector<Edge<T> *> Vertex<T>::getIncoming() const {
+template <class T, class W>
+const std::vector<Edge<T, W> *> &Vertex<T, W>::getIncoming() const {
     return this->incoming;
 }
 
-template <class T>
-void Vertex<T>::setInfo(T in) {
+template <class T, class W>
+void Vertex<T, W>::setInfo(T in) {
     this->info = in;
 }
 
-template <class T>
-void Vertex<T>::setVisited(bool visited) {
+template <class T, class W>
+void Vertex<T, W>::setVisited(bool visited) {
     this->visited = visited;
 }
 
-template <class T>
-void Vertex<T>::setProcessing(bool processing) {
+template <class T, class W>
+void Vertex<T, W>::setProcessing(bool processing) {
     this->processing = processing;
 }
 
-template <class T>
-void Vertex<T>::setIndegree(unsigned int indegree) {
+template <class T, class W>
+void Vertex<T, W>::setIndegree(unsigned int indegree) {
     this->indegree = indegree;
 }
 
-template <class T>
-void Vertex<T>::setDist(double dist) {
+template <class T, class W>
+void Vertex<T, W>::setDist(W dist) {
     this->dist = dist;
 }
 
-template <class T>
-void Vertex<T>::setPath(Edge<T> *path) {
+template <class T, class W>
+void Vertex<T, W>::setPath(Edge<T, W> *path) {
     this->path = path;
 }
 
-template <class T>
-void Vertex<T>::deleteEdge(Edge<T> *edge) {
-    Vertex<T> *dest = edge->getDest();
+template <class T, class W>
+void Vertex<T, W>::deleteEdge(Edge<T, W> *edge) {
+    Vertex<T, W> *dest = edge->getDest();
     // Remove the corresponding edge from the incoming list
     auto it = dest->incoming.begin();
     while (it != dest->incoming.end()) {
@@ -333,133 +412,163 @@ void Vertex<T>::deleteEdge(Edge<T> *edge) {
             it++;
         }
     }
-    delete edge;
+    // the reverse edge stays, without a dangling link back
+    if (edge->getReverse() != nullptr)
+        edge->getReverse()->setReverse(nullptr);
+    edge->~Edge();    // its memory goes with the arena
 }
 
 /********************** Edge  ****************************/
 
-template <class T>
-Edge<T>::Edge(Vertex<T> *orig, Vertex<T> *dest, double w): orig(orig), dest(dest), weight(w) {}
+template <class T, class W>
+Edge<T, W>::Edge(Vertex<T, W> *orig, Vertex<T, W> *dest, W w): orig(orig), dest(dest), weight(w) {}
 
-template <class T>
-Vertex<T> * Edge<T>::getDest() const {
+template <class T, class W>
+Vertex<T, W> * Edge<T, W>::getDest() const {
     return this->dest;
 }
 
-template <class T>
-double Edge<T>::getWeight() const {
+template <class T, class W>
+W Edge<T, W>::getWeight() const {
     return this->weight;
 }
 
-template <class T>
-Vertex<T> * Edge<T>::getOrig() const {
+template <class T, class W>
+Vertex<T, W> * Edge<T, W>::getOrig() const {
     return this->orig;
 }
 
-template <class T>
-Edge<T> *Edge<T>::getReverse() const {
+template <class T, class W>
+Edge<T, W> *Edge<T, W>::getReverse() const {
     return this->reverse;
 }
 
-template <class T>
-bool Edge<T>::isSelected() const {
+template <class T, class W>
+bool Edge<T, W>::isSelected() const {
     return this->selected;
 }
 
-template <class T>
-double Edge<T>::getFlow() const {
+template <class T, class W>
+double Edge<T, W>::getFlow() const {
     return flow;
 }
 
-template <class T>
-void Edge<T>::setSelected(bool selected) {
+template <class T, class W>
+void Edge<T, W>::setSelected(bool selected) {
     this->selected = selected;
 }
 
-template <class T>
-void Edge<T>::setReverse(Edge<T> *reverse) {
+template <class T, class W>
+void Edge<T, W>::setReverse(Edge<T, W> *reverse) {
     this->reverse = reverse;
 }
 
-template <class T>
-void Edge<T>::setFlow(double flow) {
+template <class T, class W>
+void Edge<T, W>::setFlow(double flow) {
     this->flow = flow;
 }
-template <class T>
-double Edge<T>::getWalkingWeight() const {
+template <class T, class W>
+W Edge<T, W>::getWalkingWeight() const {
     return this->walkingWeight;
 }
 
-template <class T>
-void Edge<T>::setWalkingWeight(double walkingWeight) {
+template <class T, class W>
+void Edge<T, W>::setWalkingWeight(W walkingWeight) {
     this->walkingWeight = walkingWeight;
 }
 
 /********************** Graph  ****************************/
 
-template <class T>
-int Graph<T>::getNumVertex() const {
-    return vertexSet.size();
+template <class T, class W>
+int Graph<T, W>::getNumVertex() const {
+    return data->vertexSet.size();
+}
+
+template <class T, class W>
+size_t Graph<T, W>::getMemoryReserved() const {
+    return data->vertexArena.getBytesReserved() + data->edgeArena.getBytesReserved();
 }
 
-template <class T>
-std::vector<Vertex<T> *> Graph<T>::getVertexSet() const {
-    return vertexSet;
+template <class T, class W>
+const std::vector<Vertex<T, W> *> &Graph<T, W>::getVertexSet() const {
+    return data->vertexSet;
 }
 
 /*
  * Auxiliary function to find a vertex with a given content.
  */
-template <class T>
-Vertex<T> * Graph<T>::findVertex(const T &in) const {
-    for (auto v : vertexSet)
-        if (v->getInfo() == in)
-            return v;
-    return nullptr;
+template <class T, class W>
+const Vertex<T, W> * Graph<T, W>::findVertex(const T &in) const {
+    int idx = findVertexIdx(in);
+    return idx == -1 ? nullptr : data->vertexSet[idx];
+}
+
+template <class T, class W>
+Vertex<T, W> * Graph<T, W>::findMutableVertex(const T &in) {
+    int idx = findVertexIdx(in);
+    return idx == -1 ? nullptr : mutableData().vertexSet[idx];
 }
 
 /*
  * Finds the index of the vertex with a given content.
  */
-template <class T>
-int Graph<T>::findVertexIdx(const T &in) const {
-    for (unsigned i = 0; i < vertexSet.size(); i++)
-        if (vertexSet[i]->getInfo() == in)
-            return i;
-    return -1;
+template <class T, class W>
+int Graph<T, W>::findVertexIdx(const T &in) const {
+    auto it = data->vertexIndex.find(in);
+    return it == data->vertexIndex.end() ? -1 : it->second;
 }
 /*
  *  Adds a vertex with a given content or info (in) to a graph (this).
  *  Returns true if successful, and false if a vertex with that content already exists.
  */
-template <class T>
-bool Graph<T>::addVertex(const T &in) {
-    if (findVertex(in) != nullptr)
+template <class T, class W>
+bool Graph<T, W>::addVertex(const T &in) {
+    if (findVertexIdx(in) != -1)
         return false;
-    vertexSet.push_back(new Vertex<T>(in));
+    Data &d = mutableData();
+    d.vertexIndex.emplace(in, d.vertexSet.size());
+    d.vertexSet.push_back(createVertex(d, in));
     return true;
 }
 
+template <class T, class W>
+Vertex<T, W> *Graph<T, W>::createVertex(Data &d, const T &in) {
+    return new (d.vertexArena.template allocate<Vertex<T, W>>()) Vertex<T, W>(in, d.edgeArena);
+}
+
+template <class T, class W>
+typename Graph<T, W>::Data &Graph<T, W>::mutableData() {
+    if (data.use_count() > 1)
+        data = std::make_shared<Data>(*data);
+    return *data;
+}
+
 /*
  *  Removes a vertex with a given content (in) from a graph (this), and
  *  all outgoing and incoming edges.
  *  Returns true if successful, and false if such vertex does not exist.
  */
-template <class T>
-bool Graph<T>::removeVertex(const T &in) {
-    for (auto it = vertexSet.begin(); it != vertexSet.end(); it++) {
-        if ((*it)->getInfo() == in) {
-            auto v = *it;
-            v->removeOutgoingEdges();
-            for (auto u : vertexSet) {
-                u->removeEdge(v->getInfo());
-            }
-            vertexSet.erase(it);
-            delete v;
-            return true;
-        }
-    }
-    return false;
+template <class T, class W>
+bool Graph<T, W>::removeVertex(const T &in) {
+    int idx = findVertexIdx(in);
+    if (idx == -1)
+        return false;
+    Data &d = mutableData();
+    auto v = d.vertexSet[idx];
+    v->removeOutgoingEdges();
+    // only the origins of incoming edges can still point to v
+    std::vector<Vertex<T, W> *> origins;
+    for (auto e : v->getIncoming())
+        origins.push_back(e->getOrig());
+    for (auto u : origins)
+        u->removeEdge(in);
+    d.vertexSet.erase(d.vertexSet.begin() + idx);
+    d.vertexIndex.erase(in);
+    // vertices after the removed one shift down by one position
+    for (unsigned i = idx; i < d.vertexSet.size(); i++)
+        d.vertexIndex[d.vertexSet[i]->getInfo()] = i;
+    v->~Vertex();
+    return true;
 }
 
 /*
@@ -467,10 +576,10 @@ bool Graph<T>::removeVertex(const T &in) {
  * destination vertices and the edge weight (w).
  * Returns true if successful, and false if the source or destination vertex does not exist.
  */
-template <class T>
-bool Graph<T>::addEdge(const T &sourc, const T &dest, double w) {
-    auto v1 = findVertex(sourc);
-    auto v2 = findVertex(dest);
+template <class T, class W>
+bool Graph<T, W>::addEdge(const T &sourc, const T &dest, W w) {
+    auto v1 = findMutableVertex(sourc);
+    auto v2 = findMutableVertex(dest);
     if (v1 == nullptr || v2 == nullptr)
         return false;
     v1->addEdge(v2, w);
@@ -482,19 +591,19 @@ bool Graph<T>::addEdge(const T &sourc, const T &dest, double w) {
  * The edge is identified by the source (sourc) and destination (dest) contents.
  * Returns true if successful, and false if such edge does not exist.
  */
-template <class T>
-bool Graph<T>::removeEdge(const T &sourc, const T &dest) {
-    Vertex<T> * srcVertex = findVertex(sourc);
+template <class T, class W>
+bool Graph<T, W>::removeEdge(const T &sourc, const T &dest) {
+    Vertex<T, W> * srcVertex = findMutableVertex(sourc);
     if (srcVertex == nullptr) {
         return false;
     }
     return srcVertex->removeEdge(dest);
 }
 
-template <class T>
-bool Graph<T>::addBidirectionalEdge(const T &sourc, const T &dest, double w) {
-    auto v1 = findVertex(sourc);
-    auto v2 = findVertex(dest);
+template <class T, class W>
+bool Graph<T, W>::addBidirectionalEdge(const T &sourc, const T &dest, W w) {
+    auto v1 = findMutableVertex(sourc);
+    auto v2 = findMutableVertex(dest);
     if (v1 == nullptr || v2 == nullptr)
         return false;
     auto e1 = v1->addEdge(v2, w);
@@ -522,10 +631,74 @@ inline void deleteMatrix(double **m, int n) {
     }
 }
 
-template <class T>
-Graph<T>::~Graph() {
-    deleteMatrix(distMatrix, vertexSet.size());
-    deleteMatrix(pathMatrix, vertexSet.size());
+template <class T, class W>
+Graph<T, W>::Graph(const Graph &other) : data(other.data) {}
+
+template <class T, class W>
+Graph<T, W> &Graph<T, W>::operator=(const Graph &other) {
+    data = other.data;
+    return *this;
+}
+
+template <class T, class W>
+Graph<T, W>::~Graph() {
+    deleteMatrix(distMatrix, getNumVertex());
+    deleteMatrix(pathMatrix, getNumVertex());
+}
+
+/*
+ * Copies every vertex and edge into the new arenas, in the same order, and
+ * points the copied edges (and reverse/path links) at the copies. The edges
+ * of every vertex are allocated side by side.
+ */
+template <class T, class W>
+Graph<T, W>::Data::Data(const Data &other) : vertexIndex(other.vertexIndex) {
+    size_t numEdges = 0;
+    for (auto v : other.vertexSet)
+        numEdges += v->adj.size();
+    vertexArena.reserve(other.vertexSet.size() * sizeof(Vertex<T, W>) + alignof(Vertex<T, W>));
+    edgeArena.reserve(numEdges * sizeof(Edge<T, W>) + alignof(Edge<T, W>));
+
+    vertexSet.reserve(other.vertexSet.size());
+    for (auto v : other.vertexSet) {
+        auto copy = new (vertexArena.allocate<Vertex<T, W>>()) Vertex<T, W>(*v);
+        copy->edgeArena = &edgeArena;
+        vertexSet.push_back(copy);
+    }
+    auto vertexCopy = [&](Vertex<T, W> *v) { return vertexSet[vertexIndex.at(v->getInfo())]; };
+
+    std::unordered_map<const Edge<T, W> *, Edge<T, W> *> edgeCopy;
+    edgeCopy.reserve(numEdges);
+    for (auto copy : vertexSet) {
+        Edge<T, W> *slot = edgeArena.allocate<Edge<T, W>>(copy->adj.size());
+        for (auto &e : copy->adj) {
+            auto edge = new (slot++) Edge<T, W>(*e);
+            edge->orig = copy;
+            edge->dest = vertexCopy(e->dest);
+            edgeCopy[e] = edge;
+            e = edge;
+        }
+    }
+    for (auto copy : vertexSet) {
+        for (auto &e : copy->adj) {
+            if (e->reverse != nullptr)
+                e->reverse = edgeCopy.at(e->reverse);
+        }
+        for (auto &e : copy->incoming)
+            e = edgeCopy.at(e);
+        if (copy->path != nullptr) {
+            auto it = edgeCopy.find(copy->path);
+            copy->path = it == edgeCopy.end() ? nullptr : it->second;
+        }
+    }
+}
+
+template <class T, class W>
+Graph<T, W>::Data::~Data() {
+    static_assert(std::is_trivially_destructible<Edge<T, W>>::value, "edges are released with the arena only");
+    // the arenas release the memory; only the vertices' edge lists need destructors
+    for (auto v : vertexSet)
+        v->~Vertex();
 }
 
 #endif /* DA_TP_CLASSES_GRAPH */
\ No newline at end of file
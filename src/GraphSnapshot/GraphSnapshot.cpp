@@ -0,0 +1,242 @@
+#include "GraphSnapshot.h"
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "../AtomicFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+namespace {
+    const char MAGIC[4] = {'R', 'P', 'G', 'S'};
+    const uint32_t VERSION = 1;
+    const size_t ALIGNMENT = 8;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        int32_t numVertex, numEdges;
+        int32_t maxWeight, maxWalkingWeight;
+        int32_t numLocations, codeBytes;
+    };
+    static_assert(sizeof(Header) % ALIGNMENT == 0, "sections after the header must stay aligned");
+
+    size_t padded(size_t bytes) {
+        return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    template <class V>
+    void writeSection(ofstream& out, const V* data, size_t count) {
+        static const char zeros[ALIGNMENT] = {};
+        size_t bytes = count * sizeof(V);
+        out.write(reinterpret_cast<const char*>(data), bytes);
+        out.write(zeros, padded(bytes) - bytes);
+    }
+
+    /*
+     * Hands out the sections of a mapped file in the order they were written.
+     */
+    class SectionReader {
+    public:
+        SectionReader(const string& filename, const char* data, size_t size)
+            : filename(filename), data(data), size(size) {}
+
+        template <class V>
+        const V* next(size_t count) {
+            size_t bytes = padded(count * sizeof(V));
+            if (bytes > size - pos) throw runtime_error("ERRO: Ficheiro truncado: " + filename);
+            const V* section = reinterpret_cast<const V*>(data + pos);
+            pos += bytes;
+            return section;
+        }
+
+    private:
+        const string& filename;
+        const char* data;
+        size_t size;
+        size_t pos = sizeof(Header);
+    };
+
+    /*
+     * Whether offsets (count + 1 entries) start at 0, never decrease and end at total.
+     */
+    bool validOffsets(const int* offsets, int count, int total) {
+        if (offsets[0] != 0 || offsets[count] != total) return false;
+        for (int i = 0; i < count; i++) {
+            if (offsets[i] > offsets[i + 1]) return false;
+        }
+        return true;
+    }
+
+    /*
+     * Whether every one of the count values is in [0, limit).
+     */
+    bool allIndices(const int* values, int count, int limit) {
+        return all_of(values, values + count, [limit](int v) { return v >= 0 && v < limit; });
+    }
+
+    /*
+     * Maps the whole file read-only; the mapping lives as long as the returned pointer.
+     */
+    shared_ptr<const void> mapFile(const string& filename, size_t& size) {
+#ifndef _WIN32
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error("ERRO: Não foi possível abrir " + filename);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw runtime_error("ERRO: Não foi possível abrir " + filename);
+        }
+        size = st.st_size;
+        if (size == 0) {
+            close(fd);
+            throw runtime_error("ERRO: Ficheiro truncado: " + filename);
+        }
+        void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) throw runtime_error("ERRO: Não foi possível mapear " + filename);
+        return shared_ptr<const void>(data, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+#else
+        ifstream in(filename, ios::binary | ios::ate);
+        if (!in.is_open()) throw runtime_error("ERRO: Não foi possível abrir " + filename);
+        size = in.tellg();
+        // uint64_t keeps every section aligned, as a mapping would be
+        auto buffer = make_shared<vector<uint64_t>>((size + ALIGNMENT - 1) / ALIGNMENT);
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(buffer->data()), size);
+        if (!in) throw runtime_error("ERRO: Ficheiro truncado: " + filename);
+        return shared_ptr<const void>(buffer, buffer->data());
+#endif
+    }
+}
+
+void GraphSnapshot::write(const string& filename, const CsrGraph<int>& network,
+                          const unordered_map<string, int>& codeToId,
+                          const unordered_map<int, bool>& parkingData) {
+    const CsrGraph<int>::Arrays& a = network.getArrays();
+    int n = a.numVertex, m = a.numEdges;
+
+    // locations by increasing ID, then code, so the file does not depend on hash order
+    vector<pair<int, string>> locations;
+    locations.reserve(codeToId.size());
+    for (const auto& [code, id] : codeToId) locations.emplace_back(id, code);
+    sort(locations.begin(), locations.end());
+
+    int numLocations = locations.size();
+    vector<int32_t> ids, codeOffsets{0};
+    vector<uint64_t> parking((numLocations + 63) / 64, 0);
+    string codes;
+    for (int i = 0; i < numLocations; i++) {
+        const auto& [id, code] = locations[i];
+        ids.push_back(id);
+        codes += code;
+        codeOffsets.push_back(codes.size());
+        auto it = parkingData.find(id);
+        if (it != parkingData.end() && it->second) parking[i / 64] |= uint64_t(1) << (i % 64);
+    }
+
+    // Written aside and renamed over filename: processes that still map the
+    // old file keep it intact instead of seeing it truncated
+    AtomicFile::write(filename, [&](ofstream& out) {
+        Header header{};
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.numVertex = n;
+        header.numEdges = m;
+        header.maxWeight = a.maxWeight;
+        header.maxWalkingWeight = a.maxWalkingWeight;
+        header.numLocations = numLocations;
+        header.codeBytes = codes.size();
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        writeSection(out, a.info, n);
+        writeSection(out, a.sortedByInfo, n);
+        writeSection(out, a.offsets, n + 1);
+        writeSection(out, a.sources, m);
+        writeSection(out, a.targets, m);
+        writeSection(out, a.weights, m);
+        writeSection(out, a.walkingWeights, m);
+        writeSection(out, a.incomingOffsets, n + 1);
+        writeSection(out, a.incomingEdges, m);
+
+        writeSection(out, ids.data(), numLocations);
+        writeSection(out, codeOffsets.data(), numLocations + 1);
+        writeSection(out, parking.data(), parking.size());
+        writeSection(out, codes.data(), codes.size());
+    });
+}
+
+GraphSnapshot GraphSnapshot::load(const string& filename) {
+    size_t size;
+    shared_ptr<const void> file = mapFile(filename, size);
+    const char* data = static_cast<const char*>(file.get());
+
+    Header header;
+    if (size < sizeof(header)) throw runtime_error("ERRO: Ficheiro truncado: " + filename);
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+        || header.numVertex < 0 || header.numEdges < 0 || header.numLocations < 0 || header.codeBytes < 0) {
+        throw runtime_error("ERRO: Formato inválido em " + filename);
+    }
+
+    int n = header.numVertex, m = header.numEdges;
+    CsrGraph<int>::Arrays a;
+    a.numVertex = n;
+    a.numEdges = m;
+    a.maxWeight = header.maxWeight;
+    a.maxWalkingWeight = header.maxWalkingWeight;
+
+    SectionReader reader(filename, data, size);
+    a.info = reader.next<int>(n);
+    a.sortedByInfo = reader.next<int>(n);
+    a.offsets = reader.next<int>(n + 1);
+    a.sources = reader.next<int>(m);
+    a.targets = reader.next<int>(m);
+    a.weights = reader.next<int>(m);
+    a.walkingWeights = reader.next<int>(m);
+    a.incomingOffsets = reader.next<int>(n + 1);
+    a.incomingEdges = reader.next<int>(m);
+
+    GraphSnapshot snapshot;
+    snapshot.numLocations = header.numLocations;
+    snapshot.locationIds = reader.next<int>(header.numLocations);
+    snapshot.codeOffsets = reader.next<int>(header.numLocations + 1);
+    snapshot.parking = reader.next<uint64_t>((header.numLocations + 63) / 64);
+    snapshot.codes = reader.next<char>(header.codeBytes);
+
+    // A damaged file must not send the searches out of the arrays
+    bool valid = validOffsets(a.offsets, n, m) && validOffsets(a.incomingOffsets, n, m)
+                 && allIndices(a.sortedByInfo, n, n) && allIndices(a.sources, m, n)
+                 && allIndices(a.targets, m, n) && allIndices(a.incomingEdges, m, m)
+                 && validOffsets(snapshot.codeOffsets, header.numLocations, header.codeBytes);
+    for (int v = 0; valid && v < n; v++) {
+        for (int e = a.offsets[v]; e < a.offsets[v + 1]; e++) valid = valid && a.sources[e] == v;
+    }
+    if (!valid) throw runtime_error("ERRO: Formato inválido em " + filename);
+
+    snapshot.network = CsrGraph<int>(a, file);
+    snapshot.file = std::move(file);
+    return snapshot;
+}
+
+unordered_map<int, bool> GraphSnapshot::getParkingData() const {
+    unordered_map<int, bool> parkingData;
+    parkingData.reserve(numLocations);
+    for (int i = 0; i < numLocations; i++) parkingData[getLocationId(i)] = isParking(i);
+    return parkingData;
+}
+
+unordered_map<string, int> GraphSnapshot::getCodeToId() const {
+    unordered_map<string, int> codeToId;
+    codeToId.reserve(numLocations);
+    for (int i = 0; i < numLocations; i++) codeToId.emplace(getLocationCode(i), getLocationId(i));
+    return codeToId;
+}
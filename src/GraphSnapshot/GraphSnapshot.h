@@ -0,0 +1,89 @@
+/**
+ * @file GraphSnapshot.h
+ * @brief Binary snapshot of the road network, mapped into memory at startup
+ */
+#ifndef GRAPH_SNAPSHOT_H
+#define GRAPH_SNAPSHOT_H
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
+#include "../CsrGraph.h"
+
+/**
+ * @class GraphSnapshot
+ * @brief CSR arrays, location codes and parking nodes of a network in one file
+ *
+ * Written once from what FileParser loaded and mapped into memory on later
+ * runs: the CsrGraph is a view of the mapped arrays, with no parsing, and
+ * processes mapping the same file share its pages in the page cache.
+ *
+ * Layout, in native byte order, every section starting at a multiple of 8 bytes:
+ *   magic "RPGS", version, numVertex, numEdges, maxWeight, maxWalkingWeight,
+ *   numLocations, codeBytes;
+ *   the CsrGraph arrays (info, sortedByInfo, offsets, sources, targets, weights,
+ *   walkingWeights, incomingOffsets, incomingEdges);
+ *   the locations by increasing ID: ids, codeOffsets (numLocations + 1),
+ *   parking bitset (one bit per location), codes (characters).
+ */
+class GraphSnapshot {
+public:
+    GraphSnapshot() = default;
+
+    /**
+     * @brief Holds a network built in memory, without locations (when no snapshot can be written)
+     */
+    explicit GraphSnapshot(CsrGraph<int> network) : network(std::move(network)) {}
+
+    /**
+     * @brief Writes a snapshot
+     * @param network CSR network of the roads
+     * @param codeToId Location codes, as returned by FileParser::loadLocationMappings
+     * @param parkingData Map of parking availability (node ID -> isParking)
+     * @throw runtime_error If the file cannot be written
+     * @note The file is written under a temporary name and renamed over
+     *       filename, so a snapshot mapped by a running process is never changed
+     */
+    static void write(const std::string& filename, const CsrGraph<int>& network,
+                      const std::unordered_map<std::string, int>& codeToId,
+                      const std::unordered_map<int, bool>& parkingData);
+
+    /**
+     * @brief Maps a snapshot written by write
+     * @throw runtime_error If the file cannot be read, has another version, is
+     *        truncated or its offsets/indices do not fit the arrays
+     * @note Without mmap (Windows) the file is read into memory instead
+     */
+    static GraphSnapshot load(const std::string& filename);
+
+    /**
+     * @brief The network, a view of the mapped file (kept mapped by it and its copies)
+     */
+    const CsrGraph<int>& getNetwork() const { return network; }
+
+    int getNumLocations() const { return numLocations; }
+    int getLocationId(int i) const { return locationIds[i]; }
+    std::string_view getLocationCode(int i) const {
+        return std::string_view(codes + codeOffsets[i], codeOffsets[i + 1] - codeOffsets[i]);
+    }
+    bool isParking(int i) const { return (parking[i / 64] >> (i % 64)) & 1; }
+
+    /**
+     * @brief The maps FileParser::loadLocationMappings returns, rebuilt from the locations
+     */
+    std::unordered_map<int, bool> getParkingData() const;
+    std::unordered_map<std::string, int> getCodeToId() const;
+
+private:
+    CsrGraph<int> network;
+    int numLocations = 0;
+    const int* locationIds = nullptr;
+    const int* codeOffsets = nullptr;
+    const uint64_t* parking = nullptr;
+    const char* codes = nullptr;
+    std::shared_ptr<const void> file;     // the mapping behind every pointer above
+};
+
+#endif // GRAPH_SNAPSHOT_H
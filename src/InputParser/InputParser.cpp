@@ -2,13 +2,14 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
-#include "../RouteFinder/RouteFinder.h"
-#include "../OutputWriter/OutputWriter.h"
+#include <chrono>
+#include "../BatchExecutor/BatchExecutor.h"
 #include "../Graph.h"
+#include "../CsrGraph.h"
 
 using namespace std;
 
-vector<int> InputParser::parseNodes(const string& str) {
+vector<int> InputParser::parseNodes(const string& str, const string& key) {
     vector<int> nodes;
     if (str.empty() || str == "none") return nodes;
 
@@ -19,7 +20,7 @@ vector<int> InputParser::parseNodes(const string& str) {
             token.erase(remove_if(token.begin(), token.end(), ::isspace), token.end());
             if (!token.empty()) nodes.push_back(stoi(token));
         } catch (...) {
-            throw runtime_error("ERRO: Valor invalido em AvoidNodes: '" + token + "'");
+            throw runtime_error("ERRO: Valor invalido em " + key + ": '" + token + "'");
         }
     }
     return nodes;
@@ -50,177 +51,140 @@ vector<pair<int, int>> InputParser::parseSegments(const string& str) {
     return segments;
 }
 
-void InputParser::processFileInput(Graph<int>& roadNetwork,
-                                 const unordered_map<int, bool>& parkingData) {
-    ifstream input("../input.txt");
-    if (!input.is_open()) {
-        cout << "ERRO: Arquivo input.txt nao encontrado" << endl;
-        return;
-    }
-
-    string mode, line;
-    int start = -1, end = -1, maxWalkTime = 0, includeNode = -1;
-    vector<int> avoidNodes;
-    vector<pair<int, int>> avoidSegments;
-
+vector<Query> InputParser::parseQueries(istream& input) {
+    vector<Query> queries;
+    Query query;
+    bool hasKeys = false;
+    auto finish = [&]() {
+        if (hasKeys) queries.push_back(query);
+        query = Query();
+        hasKeys = false;
+    };
+
+    string line;
     while (getline(input, line)) {
-        line.erase(remove(line.begin(), line.end(), ' '), line.end());
-        if (line.empty()) continue;
+        line.erase(remove_if(line.begin(), line.end(), [](char c) { return c == ' ' || c == '\r'; }), line.end());
+        if (line == "---") {
+            finish();
+            continue;
+        }
+        if (line.empty()) {
+            // Uma linha em branco so separa consultas ja completas
+            if (query.start != -1 && query.end != -1) finish();
+            continue;
+        }
 
         size_t colon = line.find(':');
         if (colon == string::npos) continue;
 
         string key = line.substr(0, colon);
         string value = line.substr(colon + 1);
+        hasKeys = true;
 
-        if (key == "Mode") mode = value;
+        if (key == "Mode") query.mode = value;
         else if (key == "Source") {
-            try { start = stoi(value); }
+            try { query.start = stoi(value); }
             catch (...) { throw runtime_error("Source invalido"); }
         }
         else if (key == "Destination") {
-            try { end = stoi(value); }
+            try { query.end = stoi(value); }
             catch (...) { throw runtime_error("Destination invalido"); }
         }
         else if (key == "MaxWalkTime") {
-            try { maxWalkTime = stoi(value); }
+            try { query.maxWalkTime = stoi(value); }
             catch (...) { cerr << "AVISO: MaxWalkTime é 0" << endl; }
         }
         else if (key == "IncludeNode") {
-            if (value.empty() || value == "none") includeNode = -1;
+            if (value.empty() || value == "none") query.includeNodes.clear();
             else {
-                try { includeNode = stoi(value); }
+                try { query.includeNodes.assign(1, stoi(value)); }
                 catch (...) { cerr << "AVISO: IncludeNode invalido" << endl; }
             }
         }
+        else if (key == "IncludeNodes") {
+            try { query.includeNodes = parseNodes(value, key); }
+            catch (const exception& e) { cerr << "AVISO: " << e.what() << endl; }
+        }
         else if (key == "AvoidNodes") {
-            try { avoidNodes = parseNodes(value); }
+            try { query.avoidNodes = parseNodes(value); }
             catch (const exception& e) { cerr << "AVISO: " << e.what() << endl; }
         }
         else if (key == "AvoidSegments") {
-            try { avoidSegments = parseSegments(value); }
+            try { query.avoidSegments = parseSegments(value); }
             catch (const exception& e) { cerr << "AVISO: " << e.what() << endl; }
         }
     }
+    finish();
+    return queries;
+}
 
-    if (start == -1 || end == -1) {
-        cout << "Erro: Origem/destino nao definidos" << endl;
-        return;
-    }
-    if (!roadNetwork.findVertex(start)) {
-        cout << "Erro: No de origem nao existe" << endl;
-        return;
-    }
-    if (!roadNetwork.findVertex(end)) {
-        cout << "Erro: No de destino nao existe" << endl;
+void InputParser::processFileInput(const CsrGraph<int>& network,
+                                 const unordered_map<int, bool>& parkingData,
+                                 const ParkingTable* parkingTable,
+                                 const ContractionHierarchy* hierarchy,
+                                 const Landmarks* landmarks,
+                                 ThreadPool* pool,
+                                 ThreadPool* batchPool) {
+    ifstream input("../input.txt");
+    if (!input.is_open()) {
+        cout << "ERRO: Arquivo input.txt nao encontrado" << endl;
         return;
     }
+    vector<Query> queries = parseQueries(input);
 
-    cout << "\n=== VALORES ===" << endl;
-    cout << "Modo: " << mode << endl;
-    cout << "Origem: " << start << " -> Destino: " << end << endl;
-
-    if (mode == "driving-walking") {
-        vector<int> drivingRoute, walkingRoute;
-        int parkingNode, totalTime;
-        string message;
-        vector<tuple<int, vector<int>, vector<int>, int>> alternatives;
-
-        bool found = RouteFinder::findHybridRoute(roadNetwork, parkingData, start, end, maxWalkTime,
-                                               avoidNodes, avoidSegments, drivingRoute, walkingRoute,
-                                               parkingNode, totalTime, message, &alternatives);
-
-        if (found) {
-            cout << "\n=== ROTA ENCONTRADA ===" << endl;
-            cout << "Trajeto de carro: ";
-            for (int node : drivingRoute) cout << node << " ";
-            cout << "\nEstacionamento: " << parkingNode;
-            cout << "\nTrajeto a pe: ";
-            for (int node : walkingRoute) cout << node << " ";
-            cout << "\nTempo total: " << totalTime << " minutos" << endl;
-        } else {
-            cout << "\n=== RESULTADO ===" << endl;
-            cout << message << endl;
+    if (queries.size() > 1) {
+        ofstream out("../output.txt");
+        if (!out.is_open()) {
+            throw runtime_error("ERROR: Unable to create ../output.txt");
         }
 
-        OutputWriter::writeHybridOutput(roadNetwork, "../output.txt", start, end,
-                                     drivingRoute, parkingNode, walkingRoute, totalTime,
-                                     message, alternatives);
-    } else {
-        Graph<int> restrictedGraph = roadNetwork;
-        for (int node : avoidNodes) restrictedGraph.removeVertex(node);
-        for (auto& seg : avoidSegments) {
-            restrictedGraph.removeEdge(seg.first, seg.second);
-            restrictedGraph.removeEdge(seg.second, seg.first);
-        }
-
-        vector<int> bestPath, altPath;
-        int bestTime = 0, altTime = 0;
-        bool hasRestrictions = !avoidNodes.empty() || !avoidSegments.empty() || (includeNode != -1);
-
-        bool found;
-        if (includeNode != -1) {
-            found = RouteFinder::findRouteWithIncludeNode(restrictedGraph, start, end, includeNode, bestPath, bestTime);
-        } else {
-            found = RouteFinder::dijkstra(restrictedGraph, start, end, bestPath, bestTime, true);
+        auto t0 = chrono::steady_clock::now();
+        int invalid = batchPool != nullptr
+            ? BatchExecutor::run(network, parkingData, queries, out, *batchPool, parkingTable, hierarchy, landmarks)
+            : BatchExecutor::run(network, parkingData, queries, out, parkingTable, hierarchy, landmarks);
+        auto t1 = chrono::steady_clock::now();
 
-            if (!hasRestrictions && found) {
-                Graph<int> altGraph = roadNetwork;
-                for (size_t i = 0; i < bestPath.size() - 1; i++) {
-                    altGraph.removeEdge(bestPath[i], bestPath[i+1]);
-                    altGraph.removeEdge(bestPath[i+1], bestPath[i]);
-                }
-
-                if (!RouteFinder::dijkstra(altGraph, start, end, altPath, altTime, true)) {
-                    Graph<int> altGraph2 = roadNetwork;
-                    for (size_t i = 1; i < bestPath.size() - 1; i++) {
-                        altGraph2.removeVertex(bestPath[i]);
-                    }
-                    RouteFinder::dijkstra(altGraph2, start, end, altPath, altTime, true);
-                }
-            }
-        }
+        cout << "\n=== LOTE ===" << endl;
+        cout << queries.size() << " consultas (" << invalid << " invalidas) em "
+             << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+        cout << "\nResultados gravados em output.txt" << endl;
+        return;
+    }
 
-        cout << "\n=== RESULTADOS ===" << endl;
-        if (found) {
-            cout << "Melhor rota (" << bestTime << " min): ";
-            for (size_t i = 0; i < bestPath.size(); i++) {
-                if (i != 0) cout << " -> ";
-                cout << bestPath[i];
-            }
-            cout << endl;
+    Query query = queries.empty() ? Query() : queries[0];
+    string error = BatchExecutor::validate(network, query);
+    if (!error.empty()) {
+        cout << "Erro: " << error << endl;
+        return;
+    }
 
-            if (!altPath.empty() && altTime < INF) {
-                cout << "\nRota alternativa (" << altTime << " min): ";
-                for (size_t i = 0; i < altPath.size(); i++) {
-                    if (i != 0) cout << " -> ";
-                    cout << altPath[i];
-                }
-                cout << endl;
-            }
-        } else {
-            cout << "Nenhuma rota encontrada" << endl;
-        }
+    cout << "\n=== VALORES ===" << endl;
+    cout << "Modo: " << query.mode << endl;
+    cout << "Origem: " << query.start << " -> Destino: " << query.end << endl;
 
-        OutputWriter::writeOutput(roadNetwork, "../output.txt", start, end,
-                               bestPath, bestTime, altPath, altTime, hasRestrictions);
+    ofstream out("../output.txt");
+    if (!out.is_open()) {
+        throw runtime_error("ERROR: Unable to create ../output.txt");
     }
+    SearchContext context(network.getNumVertex());
+    BatchExecutor::execute(network, parkingData, query, context, out, parkingTable, hierarchy, landmarks, true, pool);
     cout << "\nResultados gravados em output.txt" << endl;
 }
 
-void InputParser::processManualInput(Graph<int>& roadNetwork,
-                                   const unordered_map<int, bool>& parkingData) {
+void InputParser::processManualInput(const CsrGraph<int>& network,
+                                   const unordered_map<int, bool>& parkingData,
+                                   const ParkingTable* parkingTable,
+                                   const ContractionHierarchy* hierarchy,
+                                   const Landmarks* landmarks,
+                                   ThreadPool* pool) {
     showManualInputMenu();
 
     string input;
-    int start, end, maxWalkTime = 0, includeNode = -1;
-    vector<int> avoidNodes;
-    vector<pair<int, int>> avoidSegments;
-    string mode;
+    Query query;
 
     cout << "Modo (driving/driving-walking): ";
     getline(cin, input);
-    mode = input.empty() ? "driving" : input;
+    query.mode = input.empty() ? "driving" : input;
 
     cout << "No de origem: ";
     getline(cin, input);
@@ -228,7 +192,7 @@ void InputParser::processManualInput(Graph<int>& roadNetwork,
         cout << "No de origem e obrigatorio!\n";
         return;
     }
-    start = stoi(input);
+    query.start = stoi(input);
 
     cout << "No de destino: ";
     getline(cin, input);
@@ -236,23 +200,28 @@ void InputParser::processManualInput(Graph<int>& roadNetwork,
         cout << "No de destino e obrigatorio!\n";
         return;
     }
-    end = stoi(input);
+    query.end = stoi(input);
 
-    if (mode == "driving-walking") {
+    if (query.mode == "driving-walking") {
         cout << "Tempo maximo a pe (minutos): ";
         getline(cin, input);
-        maxWalkTime = input.empty() ? 0 : stoi(input);
+        query.maxWalkTime = input.empty() ? 0 : stoi(input);
     } else {
-        cout << "No a incluir (ou deixe em branco): ";
+        cout << "Nos a incluir (separados por virgula, ou deixe em branco): ";
         getline(cin, input);
-        includeNode = input.empty() ? -1 : stoi(input);
+        try {
+            query.includeNodes = parseNodes(input, "IncludeNodes");
+        } catch (const exception& e) {
+            cout << "Erro: " << e.what() << endl;
+            return;
+        }
     }
 
     cout << "Nos a evitar (separados por virgula, ou deixe em branco): ";
     getline(cin, input);
     if (!input.empty()) {
         try {
-            avoidNodes = parseNodes(input);
+            query.avoidNodes = parseNodes(input);
         } catch (const exception& e) {
             cout << "Erro: " << e.what() << endl;
             return;
@@ -263,108 +232,25 @@ void InputParser::processManualInput(Graph<int>& roadNetwork,
     getline(cin, input);
     if (!input.empty()) {
         try {
-            avoidSegments = parseSegments(input);
+            query.avoidSegments = parseSegments(input);
         } catch (const exception& e) {
             cout << "Erro: " << e.what() << endl;
             return;
         }
     }
 
-    if (!roadNetwork.findVertex(start)) {
-        cout << "Erro: No de origem nao existe!\n";
-        return;
-    }
-    if (!roadNetwork.findVertex(end)) {
-        cout << "Erro: No de destino nao existe!\n";
+    string error = BatchExecutor::validate(network, query);
+    if (!error.empty()) {
+        cout << "Erro: " << error << "!\n";
         return;
     }
 
-    if (mode == "driving-walking") {
-        vector<int> drivingRoute, walkingRoute;
-        int parkingNode, totalTime;
-        string message;
-        vector<tuple<int, vector<int>, vector<int>, int>> alternatives;
-
-        bool found = RouteFinder::findHybridRoute(roadNetwork, parkingData, start, end, maxWalkTime,
-                                               avoidNodes, avoidSegments, drivingRoute, walkingRoute,
-                                               parkingNode, totalTime, message, &alternatives);
-
-        if (found) {
-            cout << "\n=== RESULTADO ===" << endl;
-            cout << "Rota encontrada!" << endl;
-            cout << "Trajeto de carro: ";
-            for (int node : drivingRoute) cout << node << " ";
-            cout << "\nEstacionamento: " << parkingNode;
-            cout << "\nTrajeto a pe: ";
-            for (int node : walkingRoute) cout << node << " ";
-            cout << "\nTempo total: " << totalTime << endl;
-        } else {
-            cout << "\n=== RESULTADO ===" << endl;
-            cout << message << endl;
-        }
-
-        OutputWriter::writeHybridOutput(roadNetwork, "../output.txt", start, end,
-                                     drivingRoute, parkingNode, walkingRoute, totalTime,
-                                     message, alternatives);
-    } else {
-        Graph<int> restrictedGraph = roadNetwork;
-        for (int node : avoidNodes) restrictedGraph.removeVertex(node);
-        for (auto& seg : avoidSegments) {
-            restrictedGraph.removeEdge(seg.first, seg.second);
-            restrictedGraph.removeEdge(seg.second, seg.first);
-        }
-
-        vector<int> bestPath, altPath;
-        int bestTime = 0, altTime = 0;
-        bool hasRestrictions = !avoidNodes.empty() || !avoidSegments.empty() || (includeNode != -1);
-
-        bool found;
-        if (includeNode != -1) {
-            found = RouteFinder::findRouteWithIncludeNode(restrictedGraph, start, end, includeNode, bestPath, bestTime);
-        } else {
-            found = RouteFinder::dijkstra(restrictedGraph, start, end, bestPath, bestTime, true);
-
-            if (!hasRestrictions && found) {
-                Graph<int> altGraph = roadNetwork;
-                for (size_t i = 0; i < bestPath.size() - 1; i++) {
-                    altGraph.removeEdge(bestPath[i], bestPath[i+1]);
-                    altGraph.removeEdge(bestPath[i+1], bestPath[i]);
-                }
-
-                if (!RouteFinder::dijkstra(altGraph, start, end, altPath, altTime, true)) {
-                    Graph<int> altGraph2 = roadNetwork;
-                    for (size_t i = 1; i < bestPath.size() - 1; i++) {
-                        altGraph2.removeVertex(bestPath[i]);
-                    }
-                    RouteFinder::dijkstra(altGraph2, start, end, altPath, altTime, true);
-                }
-            }
-        }
-
-        cout << "\n=== RESULTADOS ===" << endl;
-        if (found) {
-            cout << "Melhor rota (" << bestTime << " min): ";
-            for (size_t i = 0; i < bestPath.size(); i++) {
-                if (i != 0) cout << " -> ";
-                cout << bestPath[i];
-            }
-            cout << endl;
-
-            if (!altPath.empty() && altTime < INF) {
-                cout << "\nRota alternativa (" << altTime << " min): ";
-                for (size_t i = 0; i < altPath.size(); i++) {
-                    if (i != 0) cout << " -> ";
-                    cout << altPath[i];
-                }
-                cout << endl;
-            }
-        } else {
-            cout << "Nenhuma rota encontrada" << endl;
-        }
-
-        OutputWriter::writeOutput(roadNetwork, "../output.txt", start, end,
-                               bestPath, bestTime, altPath, altTime, hasRestrictions);
+    ofstream out("../output.txt");
+    if (!out.is_open()) {
+        throw runtime_error("ERROR: Unable to create ../output.txt");
     }
+    SearchContext context(network.getNumVertex());
+    BatchExecutor::execute(network, parkingData, query, context, out, parkingTable, hierarchy, landmarks, true, pool);
     cout << "\nResultados gravados em output.txt" << endl;
 }
 void InputParser::showManualInputMenu() {
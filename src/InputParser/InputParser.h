@@ -9,11 +9,28 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include <istream>
 #include <unordered_map>
 #include "../Graph.h"
+#include "../CsrGraph.h"
+#include "../ParkingTable/ParkingTable.h"
+#include "../ContractionHierarchy/ContractionHierarchy.h"
+#include "../Landmarks/Landmarks.h"
+#include "../ThreadPool.h"
 
 using namespace std;
 
+/**
+ * @brief One route request, as read from an input.txt block
+ */
+struct Query {
+    string mode;
+    int start = -1, end = -1, maxWalkTime = 0;
+    vector<int> includeNodes;       // stops, in any order
+    vector<int> avoidNodes;
+    vector<pair<int, int>> avoidSegments;
+};
+
 /**
  * @class InputParser
  * @brief Provides methods for parsing route finding inputs from files and manual entry
@@ -25,11 +42,12 @@ public:
     /**
     * @brief Parses a string of comma-separated node IDs
     * @param str Input string containing node IDs separated by commas
+    * @param key Input key named in the error message
     * @return Vector of parsed node IDs
     * @throw runtime_error If invalid node IDs are found
     * @note Handles "none" and empty strings as empty vectors
     */
-    static vector<int> parseNodes(const string& str);
+    static vector<int> parseNodes(const string& str, const string& key = "AvoidNodes");
 
     /**
     * @brief Parses segments in format (a,b)(c,d)
@@ -40,11 +58,26 @@ public:
     */
     static vector<pair<int, int>> parseSegments(const string& str);
 
+    /**
+    * @brief Parses the queries of an input file
+    * @param input Stream with one or more Mode/Source/Destination/... blocks
+    * @return Queries in input order
+    * @throw runtime_error If a Source or Destination is not a number
+    * @note Blocks are separated by "---", or by a blank line once the block
+    *       has its Source and Destination
+    */
+    static vector<Query> parseQueries(istream& input);
+
     /**
      * @brief Processes input from a configuration file
-     * @param roadNetwork Reference to the road network graph
+     * @param network CSR network of the roads
      * @param parkingData Map of parking node availability
-     *
+     * @param parkingTable Optional precomputed parking walking times (see ParkingTable)
+     * @param hierarchy Optional contraction hierarchy for the driving queries
+     * @param landmarks Optional landmark distances for the restricted driving queries
+     * @param pool Optional worker pool for the searches of a single driving-walking query
+     * @param batchPool Optional worker pool for a batch (several queries); without
+     *        it the batch runs on the calling thread
      * Reads from "../input.txt" with format:
      * Mode:driving-walking
      * Source:1
@@ -52,14 +85,27 @@ public:
      * MaxWalkTime:10
      * AvoidNodes:2,3
      * AvoidSegments:(1,2)(3,4)
+     * IncludeNodes:4,7,9 (driving; IncludeNode:4 for a single stop)
+     *
+     * With several query blocks the file is run as a batch on batchPool (see
+     * BatchExecutor) and output.txt gets every result, in input order.
      */
-    static void processFileInput(Graph<int>& roadNetwork,
-                               const unordered_map<int, bool>& parkingData);
+    static void processFileInput(const CsrGraph<int>& network,
+                               const unordered_map<int, bool>& parkingData,
+                               const ParkingTable* parkingTable = nullptr,
+                               const ContractionHierarchy* hierarchy = nullptr,
+                               const Landmarks* landmarks = nullptr,
+                               ThreadPool* pool = nullptr,
+                               ThreadPool* batchPool = nullptr);
 
     /**
     * @brief Processes manual user input through console
-    * @param roadNetwork Reference to the road network graph
+    * @param network CSR network of the roads
     * @param parkingData Map of parking node availability
+    * @param parkingTable Optional precomputed parking walking times (see ParkingTable)
+    * @param hierarchy Optional contraction hierarchy for the driving queries
+    * @param landmarks Optional landmark distances for the restricted driving queries
+    * @param pool Optional worker pool for the searches of a driving-walking query
     *
     * Guides user through step-by-step input:
     * 1. Mode selection
@@ -67,8 +113,12 @@ public:
     * 3. Parameters based on mode
     * 4. Avoidance constraints
     */
-    static void processManualInput(Graph<int>& roadNetwork,
-                                 const unordered_map<int, bool>& parkingData);
+    static void processManualInput(const CsrGraph<int>& network,
+                                 const unordered_map<int, bool>& parkingData,
+                                 const ParkingTable* parkingTable = nullptr,
+                                 const ContractionHierarchy* hierarchy = nullptr,
+                                 const Landmarks* landmarks = nullptr,
+                                 ThreadPool* pool = nullptr);
 
     /**
     * @brief Displays manual input menu
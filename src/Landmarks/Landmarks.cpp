@@ -0,0 +1,161 @@
+#include "Landmarks.h"
+#include <queue>
+#include <climits>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include "../AtomicFile.h"
+
+using namespace std;
+
+namespace {
+    const int UNREACHABLE = Landmarks::UNREACHABLE;
+    const char MAGIC[4] = {'R', 'P', 'L', 'M'};
+    const uint32_t VERSION = 1;
+
+    template <class V>
+    void writeVector(ofstream& out, const vector<V>& v) {
+        out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(V));
+    }
+
+    template <class V>
+    void readVector(ifstream& in, vector<V>& v, size_t count) {
+        v.resize(count);
+        in.read(reinterpret_cast<char*>(v.data()), count * sizeof(V));
+    }
+
+    /*
+     * One-to-all times from source (to source when reverse), written to dist.
+     */
+    void distances(const CsrGraph<int>& network, int source, bool driving, bool reverse, int* dist) {
+        int n = network.getNumVertex();
+        fill(dist, dist + n, UNREACHABLE);
+
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
+        dist[source] = 0;
+        pq.emplace(0, source);
+        while (!pq.empty()) {
+            auto [d, u] = pq.top();
+            pq.pop();
+            if (d > dist[u]) continue;
+
+            int begin = reverse ? network.incomingBegin(u) : network.edgesBegin(u);
+            int end = reverse ? network.incomingEnd(u) : network.edgesEnd(u);
+            for (int i = begin; i < end; i++) {
+                int e = reverse ? network.getIncomingEdge(i) : i;
+                if (driving && network.getWeight(e) < 0) continue;
+                int v = reverse ? network.getOrig(e) : network.getDest(e);
+                int newDist = d + (driving ? network.getWeight(e) : network.getWalkingWeight(e));
+                if (newDist < dist[v]) {
+                    dist[v] = newDist;
+                    pq.emplace(newDist, v);
+                }
+            }
+        }
+    }
+}
+
+Landmarks Landmarks::build(const CsrGraph<int>& network, int count) {
+    Landmarks landmarks;
+    landmarks.count = min(count, network.getNumVertex());
+    landmarks.numVertex = network.getNumVertex();
+    landmarks.fingerprint = network.getFingerprint();
+    buildMode(network, landmarks.count, true, landmarks.driving);
+    buildMode(network, landmarks.count, false, landmarks.walking);
+    return landmarks;
+}
+
+void Landmarks::save(const string& filename) const {
+    AtomicFile::write(filename, [&](ofstream& out) {
+        int32_t header[2] = {numVertex, count};
+        out.write(MAGIC, sizeof(MAGIC));
+        out.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+        for (const Mode* mode : {&driving, &walking}) {
+            writeVector(out, mode->nodes);
+            writeVector(out, mode->from);
+            writeVector(out, mode->to);
+        }
+    });
+}
+
+Landmarks Landmarks::load(const string& filename, const CsrGraph<int>& network) {
+    ifstream in(filename, ios::binary);
+    if (!in.is_open()) throw runtime_error("ERRO: Não foi possível abrir " + filename);
+
+    char magic[4];
+    uint32_t version;
+    int32_t header[2];
+    Landmarks landmarks;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    in.read(reinterpret_cast<char*>(&landmarks.fingerprint), sizeof(landmarks.fingerprint));
+    if (!in || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION) {
+        throw runtime_error("ERRO: Formato inválido em " + filename);
+    }
+
+    int n = header[0];
+    landmarks.numVertex = n;
+    landmarks.count = header[1];
+    if (n != network.getNumVertex() || landmarks.count < 0 || landmarks.count > n
+        || landmarks.fingerprint != network.getFingerprint()) {
+        throw runtime_error("ERRO: " + filename + " não corresponde à rede carregada");
+    }
+    for (Mode* mode : {&landmarks.driving, &landmarks.walking}) {
+        readVector(in, mode->nodes, landmarks.count);
+        readVector(in, mode->from, (size_t) landmarks.count * n);
+        readVector(in, mode->to, (size_t) landmarks.count * n);
+    }
+    if (!in) throw runtime_error("ERRO: Ficheiro truncado: " + filename);
+    return landmarks;
+}
+
+/*
+ * Farthest selection: every new landmark is the node farthest from the
+ * landmarks chosen so far (nodes none of them reaches count as farthest).
+ * The first one is the node farthest from node 0.
+ */
+void Landmarks::buildMode(const CsrGraph<int>& network, int count, bool driving, Mode& mode) {
+    int n = network.getNumVertex();
+    mode.from.resize((size_t) count * n);
+    mode.to.resize((size_t) count * n);
+
+    vector<int> nearest(n, UNREACHABLE);   // distance to the closest landmark
+    vector<int> seed(n);
+    distances(network, 0, driving, false, seed.data());
+
+    int next = 0;
+    for (int v = 0; v < n; v++) {
+        if (seed[v] != UNREACHABLE && seed[v] > seed[next]) next = v;
+    }
+
+    for (int l = 0; l < count; l++) {
+        mode.nodes.push_back(next);
+        int* from = &mode.from[(size_t) l * n];
+        distances(network, next, driving, false, from);
+        distances(network, next, driving, true, &mode.to[(size_t) l * n]);
+
+        for (int v = 0; v < n; v++) nearest[v] = min(nearest[v], from[v]);
+        nearest[next] = 0;
+        next = max_element(nearest.begin(), nearest.end()) - nearest.begin();
+    }
+}
+
+int Landmarks::lowerBound(int v, int t, bool driving) const {
+    const Mode& mode = driving ? this->driving : walking;
+    int bound = 0;
+    for (int l = 0; l < count; l++) {
+        const int* from = &mode.from[(size_t) l * numVertex];
+        const int* to = &mode.to[(size_t) l * numVertex];
+        // a bound needs both of its distances; the others say nothing
+        if (from[t] != UNREACHABLE && from[v] != UNREACHABLE) bound = max(bound, from[t] - from[v]);
+        if (to[t] != UNREACHABLE) {
+            if (to[v] == UNREACHABLE) return UNREACHABLE;
+            bound = max(bound, to[v] - to[t]);
+        }
+    }
+    return bound;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file Landmarks.h
+ * @brief Landmark distances for goal-directed (ALT) searches
+ */
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <vector>
+#include <string>
+#include <climits>
+#include <cstdint>
+#include "../CsrGraph.h"
+
+/**
+ * @class Landmarks
+ * @brief Distances from and to a few landmark nodes, for A* lower bounds
+ *
+ * locations.csv has no coordinates, so the A* heuristic comes from the
+ * triangle inequality instead: for a landmark L,
+ *   d(v,t) >= d(L,t) - d(L,v)   and   d(v,t) >= d(v,L) - d(t,L).
+ * Avoiding nodes or segments only makes distances longer, so the bounds
+ * stay valid under any SearchOverlay.
+ *
+ * Landmarks are chosen by farthest selection, separately for the driving
+ * and the walking weights.
+ */
+class Landmarks {
+public:
+    Landmarks() = default;
+
+    /**
+     * @brief Chooses the landmarks and computes their distances
+     * @param network CSR network of the roads
+     * @param count Number of landmarks per mode
+     */
+    static Landmarks build(const CsrGraph<int>& network, int count);
+
+    /**
+     * @brief Writes the landmark distances to a binary file
+     * @throw runtime_error If the file cannot be written
+     * @note Written under a temporary name and renamed over filename (see AtomicFile)
+     */
+    void save(const std::string& filename) const;
+
+    /**
+     * @brief Reads landmark distances written by save
+     * @param network Network they must have been computed on
+     * @throw runtime_error If the file cannot be read, is damaged or was built
+     *        for another network (see CsrGraph::getFingerprint)
+     */
+    static Landmarks load(const std::string& filename, const CsrGraph<int>& network);
+
+    int getCount() const { return count; }
+
+    static constexpr int UNREACHABLE = INT_MAX;
+
+    /**
+     * @brief Lower bound on the time from v to t (dense indices)
+     * @param driving Driving (drivable edges only) or walking weights
+     * @return UNREACHABLE if some landmark is reachable from t but not from v,
+     *         so t cannot be reached from v either
+     */
+    int lowerBound(int v, int t, bool driving) const;
+
+private:
+    /**
+     * @brief Landmark distances for one mode, landmark-major: [l * N + v]
+     */
+    struct Mode {
+        std::vector<int> nodes;     // dense index of every landmark
+        std::vector<int> from;      // d(landmark, v), UNREACHABLE if none
+        std::vector<int> to;        // d(v, landmark), UNREACHABLE if none
+    };
+
+    int count = 0;
+    int numVertex = 0;
+    uint64_t fingerprint = 0;       // of the network they were computed on
+    Mode driving, walking;
+
+    static void buildMode(const CsrGraph<int>& network, int count, bool driving, Mode& mode);
+};
+
+#endif // LANDMARKS_H
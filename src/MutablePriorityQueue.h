@@ -10,12 +10,14 @@
 #define DA_TP_CLASSES_MUTABLEPRIORITYQUEUE
 
 #include <vector>
+#include <algorithm>
 
 /**
  * class T must have: (i) accessible field int queueIndex; (ii) operator< defined.
+ * D is the number of children of every node (binary heap by default).
 */
 
-template <class T>
+template <class T, unsigned D = 2>
 class MutablePriorityQueue {
     std::vector<T *> H;
     void heapifyUp(unsigned i);
@@ -25,28 +27,35 @@ public:
     MutablePriorityQueue();
     void insert(T * x);
     T * extractMin();
+    T * top();
     void decreaseKey(T * x);
     bool empty();
+    void clear();
 };
 
 // Index calculations
-#define parent(i) ((i) / 2)
-#define leftChild(i) ((i) * 2)
+#define parent(i) (((i) - 2) / D + 1)
+#define leftChild(i) (((i) - 1) * D + 2)
 
-template <class T>
-MutablePriorityQueue<T>::MutablePriorityQueue() {
+template <class T, unsigned D>
+MutablePriorityQueue<T, D>::MutablePriorityQueue() {
     H.push_back(nullptr);
     // indices will be used starting in 1
     // to facilitate parent/child calculations
 }
 
-template <class T>
-bool MutablePriorityQueue<T>::empty() {
+template <class T, unsigned D>
+bool MutablePriorityQueue<T, D>::empty() {
     return H.size() == 1;
 }
 
-template <class T>
-T* MutablePriorityQueue<T>::extractMin() {
+template <class T, unsigned D>
+void MutablePriorityQueue<T, D>::clear() {
+    H.resize(1);
+}
+
+template <class T, unsigned D>
+T* MutablePriorityQueue<T, D>::extractMin() {
     auto x = H[1];
     H[1] = H.back();
     H.pop_back();
@@ -55,19 +64,24 @@ T* MutablePriorityQueue<T>::extractMin() {
     return x;
 }
 
-template <class T>
-void MutablePriorityQueue<T>::insert(T *x) {
+template <class T, unsigned D>
+T* MutablePriorityQueue<T, D>::top() {
+    return H[1];
+}
+
+template <class T, unsigned D>
+void MutablePriorityQueue<T, D>::insert(T *x) {
     H.push_back(x);
     heapifyUp(H.size()-1);
 }
 
-template <class T>
-void MutablePriorityQueue<T>::decreaseKey(T *x) {
+template <class T, unsigned D>
+void MutablePriorityQueue<T, D>::decreaseKey(T *x) {
     heapifyUp(x->queueIndex);
 }
 
-template <class T>
-void MutablePriorityQueue<T>::heapifyUp(unsigned i) {
+template <class T, unsigned D>
+void MutablePriorityQueue<T, D>::heapifyUp(unsigned i) {
     auto x = H[i];
     while (i > 1 && *x < *H[parent(i)]) {
         set(i, H[parent(i)]);
@@ -76,15 +90,17 @@ void MutablePriorityQueue<T>::heapifyUp(unsigned i) {
     set(i, x);
 }
 
-template <class T>
-void MutablePriorityQueue<T>::heapifyDown(unsigned i) {
+template <class T, unsigned D>
+void MutablePriorityQueue<T, D>::heapifyDown(unsigned i) {
     auto x = H[i];
     while (true) {
         unsigned k = leftChild(i);
         if (k >= H.size())
             break;
-        if (k+1 < H.size() && *H[k+1] < *H[k])
-            ++k; // right child of i
+        unsigned last = std::min<unsigned>(k + D, H.size());
+        for (unsigned c = k + 1; c < last; c++)
+            if (*H[c] < *H[k])
+                k = c; // smallest child of i
         if ( ! (*H[k] < *x) )
             break;
         set(i, H[k]);
@@ -93,8 +109,8 @@ void MutablePriorityQueue<T>::heapifyDown(unsigned i) {
     set(i, x);
 }
 
-template <class T>
-void MutablePriorityQueue<T>::set(unsigned i, T * x) {
+template <class T, unsigned D>
+void MutablePriorityQueue<T, D>::set(unsigned i, T * x) {
     H[i] = x;
     x->queueIndex = i;
 }
@@ -15,13 +15,14 @@
 #include <tuple>
 #include <unordered_map>
 #include "../Graph.h"
+#include "../CsrGraph.h"
 #include "../MutablePriorityQueue.h"
 #include "OutputWriter.h"
 
 using namespace std;
 
 
-void OutputWriter::writeOutput(Graph<int>& roadNetwork, const string& filename, int start, int end,
+void OutputWriter::writeOutput(const CsrGraph<int>& network, const string& filename, int start, int end,
                 const vector<int>& bestPath, int bestTime,
                 const vector<int>& altPath, int altTime,
                 bool hasRestrictions) {
@@ -29,12 +30,18 @@ void OutputWriter::writeOutput(Graph<int>& roadNetwork, const string& filename,
     if (!out.is_open()) {
         throw runtime_error("ERROR: Unable to create " + filename);
     }
+    writeOutput(network, out, start, end, bestPath, bestTime, altPath, altTime, hasRestrictions);
+}
 
+void OutputWriter::writeOutput(const CsrGraph<int>& network, ostream& out, int start, int end,
+                const vector<int>& bestPath, int bestTime,
+                const vector<int>& altPath, int altTime,
+                bool hasRestrictions) {
     out << "Source:" << start << "\n";
     out << "Destination:" << end << "\n";
 
     if (hasRestrictions) {
-        if (!bestPath.empty() && bestTime < INF) {
+        if (!bestPath.empty() && bestTime < INT_MAX) {
             out << "RestrictedDrivingRoute:";
             for (size_t i = 0; i < bestPath.size(); i++) {
                 if (i != 0) out << ",";
@@ -45,7 +52,7 @@ void OutputWriter::writeOutput(Graph<int>& roadNetwork, const string& filename,
             out << "RestrictedDrivingRoute:none\n";
         }
     } else {
-        if (!bestPath.empty() && bestTime < INF) {
+        if (!bestPath.empty() && bestTime < INT_MAX) {
             out << "BestDrivingRoute:";
             for (size_t i = 0; i < bestPath.size(); i++) {
                 if (i != 0) out << ",";
@@ -56,7 +63,7 @@ void OutputWriter::writeOutput(Graph<int>& roadNetwork, const string& filename,
             out << "BestDrivingRoute:none\n";
         }
 
-        if (!altPath.empty() && altTime < INF) {
+        if (!altPath.empty() && altTime < INT_MAX) {
             out << "AlternativeDrivingRoute:";
             for (size_t i = 0; i < altPath.size(); i++) {
                 if (i != 0) out << ",";
@@ -70,7 +77,7 @@ void OutputWriter::writeOutput(Graph<int>& roadNetwork, const string& filename,
 }
 
 
-void OutputWriter::writeHybridOutput(Graph<int>& roadNetwork, const string& filename, int start, int end,
+void OutputWriter::writeHybridOutput(const CsrGraph<int>& network, const string& filename, int start, int end,
                       const vector<int>& drivingRoute, int parkingNode,
                       const vector<int>& walkingRoute, int totalTime,
                       const string& message,
@@ -79,7 +86,15 @@ void OutputWriter::writeHybridOutput(Graph<int>& roadNetwork, const string& file
     if (!out.is_open()) {
         throw runtime_error("ERROR: Unable to create " + filename);
     }
+    writeHybridOutput(network, out, start, end, drivingRoute, parkingNode, walkingRoute, totalTime,
+                      message, alternatives);
+}
 
+void OutputWriter::writeHybridOutput(const CsrGraph<int>& network, ostream& out, int start, int end,
+                      const vector<int>& drivingRoute, int parkingNode,
+                      const vector<int>& walkingRoute, int totalTime,
+                      const string& message,
+                      const vector<tuple<int, vector<int>, vector<int>, int>>& alternatives) {
     out << "Source:" << start << "\n";
     out << "Destination:" << end << "\n";
 
@@ -104,10 +119,11 @@ void OutputWriter::writeHybridOutput(Graph<int>& roadNetwork, const string& file
             // Calcula tempo de condução separadamente
             int driveTime = 0;
             for (size_t j = 0; j < drivePath.size() - 1; j++) {
-                auto v = roadNetwork.findVertex(drivePath[j]);
-                for (auto e : v->getAdj()) {
-                    if (e->getDest()->getInfo() == drivePath[j+1]) {
-                        driveTime += e->getWeight();
+                int v = network.findVertexIdx(drivePath[j]);
+                int next = network.findVertexIdx(drivePath[j+1]);
+                for (int e = network.edgesBegin(v); e < network.edgesEnd(v); e++) {
+                    if (network.getDest(e) == next) {
+                        driveTime += network.getWeight(e);
                         break;
                     }
                 }
@@ -135,10 +151,11 @@ void OutputWriter::writeHybridOutput(Graph<int>& roadNetwork, const string& file
         // Calcula tempos separadamente para rota principal
         int driveTime = 0;
         for (size_t i = 0; i < drivingRoute.size() - 1; i++) {
-            auto v = roadNetwork.findVertex(drivingRoute[i]);
-            for (auto e : v->getAdj()) {
-                if (e->getDest()->getInfo() == drivingRoute[i+1]) {
-                    driveTime += e->getWeight();
+            int v = network.findVertexIdx(drivingRoute[i]);
+            int next = network.findVertexIdx(drivingRoute[i+1]);
+            for (int e = network.edgesBegin(v); e < network.edgesEnd(v); e++) {
+                if (network.getDest(e) == next) {
+                    driveTime += network.getWeight(e);
                     break;
                 }
             }
@@ -7,9 +7,11 @@
 #define OUTPUT_WRITER_H
 
 #include "../Graph.h"
+#include "../CsrGraph.h"
 #include <vector>
 #include <string>
 #include <tuple>
+#include <ostream>
 
 /**
  * @class OutputWriter
@@ -25,7 +27,7 @@ public:
     /**
  * @brief Writes the output of the best found route
  *
- * @param roadNetwork Graph of the road network
+ * @param network CSR network of the roads
  * @param filename Output file name
  * @param start Source node
  * @param end Destination node
@@ -37,7 +39,15 @@ public:
  *
  * @throws std::runtime_error If file creation fails
  */
-    static void writeOutput(Graph<int>&, const std::string&, int, int,
+    static void writeOutput(const CsrGraph<int>&, const std::string&, int, int,
+                          const std::vector<int>&, int,
+                          const std::vector<int>&, int,
+                          bool);
+
+    /**
+ * @brief Same as writeOutput, to an already open stream (e.g. a batch output)
+ */
+    static void writeOutput(const CsrGraph<int>&, std::ostream&, int, int,
                           const std::vector<int>&, int,
                           const std::vector<int>&, int,
                           bool);
@@ -45,7 +55,7 @@ public:
     /**
  * @brief Writes the output for a hybrid route (driving + walking)
  *
- * @param roadNetwork Graph of the road network
+ * @param network CSR network of the roads
  * @param filename Output file name
  * @param start Source node
  * @param end Destination node
@@ -58,7 +68,16 @@ public:
  *
  * @throws std::runtime_error If file creation fails
  */
-    static void writeHybridOutput(Graph<int>&, const std::string&, int, int,
+    static void writeHybridOutput(const CsrGraph<int>&, const std::string&, int, int,
+                                const std::vector<int>&, int,
+                                const std::vector<int>&, int,
+                                const std::string& = "",
+                                const std::vector<std::tuple<int, std::vector<int>, std::vector<int>, int>>& = {});
+
+    /**
+ * @brief Same as writeHybridOutput, to an already open stream (e.g. a batch output)
+ */
+    static void writeHybridOutput(const CsrGraph<int>&, std::ostream&, int, int,
                                 const std::vector<int>&, int,
                                 const std::vector<int>&, int,
                                 const std::string& = "",
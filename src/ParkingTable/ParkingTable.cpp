@@ -0,0 +1,123 @@
+#include "ParkingTable.h"
+#include <fstream>
+#include <queue>
+#include <tuple>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "../AtomicFile.h"
+
+using namespace std;
+
+namespace {
+    const char MAGIC[4] = {'R', 'P', 'P', 'T'};
+    const uint32_t VERSION = 2;
+
+    template <class V>
+    void writeVector(ofstream& out, const vector<V>& v) {
+        out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(V));
+    }
+
+    template <class V>
+    void readVector(ifstream& in, vector<V>& v, size_t count) {
+        v.resize(count);
+        in.read(reinterpret_cast<char*>(v.data()), count * sizeof(V));
+    }
+}
+
+uint64_t ParkingTable::getFingerprint(const CsrGraph<int>& network, const unordered_map<int, bool>& parkingData) {
+    uint64_t hash = network.getFingerprint();
+    for (int v = 0; v < network.getNumVertex(); v++) {
+        auto it = parkingData.find(network.getInfo(v));
+        hash = (hash ^ (it != parkingData.end() && it->second)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+ParkingTable ParkingTable::build(const CsrGraph<int>& network,
+                                 const unordered_map<int, bool>& parkingData, int k) {
+    ParkingTable table;
+    int n = network.getNumVertex();
+    table.k = k;
+    table.fingerprint = getFingerprint(network, parkingData);
+    table.sizes.assign(n, 0);
+    table.entries.resize((size_t) n * k);
+    for (int v = 0; v < n; v++) table.ids.push_back(network.getInfo(v));
+
+    // {walkTime, node, parking}: every node is settled once per parking node,
+    // up to k times, in order of walking time
+    priority_queue<tuple<int, int, int>, vector<tuple<int, int, int>>, greater<tuple<int, int, int>>> pq;
+    for (int v = 0; v < n; v++) {
+        if (parkingData.at(network.getInfo(v))) pq.emplace(0, v, v);
+    }
+
+    while (!pq.empty()) {
+        auto [walkTime, v, parking] = pq.top();
+        pq.pop();
+
+        Entry* first = &table.entries[(size_t) v * k];
+        Entry* last = first + table.sizes[v];
+        if (table.sizes[v] == k) continue;
+        if (any_of(first, last, [&](const Entry& e) { return e.parking == parking; })) continue;
+        *last = {parking, walkTime};
+        table.sizes[v]++;
+
+        for (int e = network.edgesBegin(v); e < network.edgesEnd(v); e++) {
+            int w = network.getDest(e);
+            if (table.sizes[w] < k) {
+                pq.emplace(walkTime + network.getWalkingWeight(e), w, parking);
+            }
+        }
+    }
+    return table;
+}
+
+void ParkingTable::save(const string& filename) const {
+    AtomicFile::write(filename, [&](ofstream& out) {
+        int32_t header[2] = {(int32_t) ids.size(), k};
+        out.write(MAGIC, sizeof(MAGIC));
+        out.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+        writeVector(out, ids);
+        writeVector(out, sizes);
+        writeVector(out, entries);
+    });
+}
+
+ParkingTable ParkingTable::load(const string& filename, const CsrGraph<int>& network,
+                                const unordered_map<int, bool>& parkingData) {
+    ifstream in(filename, ios::binary);
+    if (!in.is_open()) throw runtime_error("ERRO: Não foi possível abrir " + filename);
+
+    char magic[4];
+    uint32_t version;
+    int32_t header[2];
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    ParkingTable table;
+    in.read(reinterpret_cast<char*>(&table.fingerprint), sizeof(table.fingerprint));
+    if (!in || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION) {
+        throw runtime_error("ERRO: Formato inválido em " + filename);
+    }
+
+    int n = header[0];
+    table.k = header[1];
+    // e.g. Distances.csv changed its weights since the table was built
+    if (n != network.getNumVertex() || table.k <= 0 || table.fingerprint != getFingerprint(network, parkingData)) {
+        throw runtime_error("ERRO: " + filename + " não corresponde à rede carregada");
+    }
+    readVector(in, table.ids, n);
+    readVector(in, table.sizes, n);
+    readVector(in, table.entries, (size_t) n * table.k);
+    if (!in) throw runtime_error("ERRO: Ficheiro truncado: " + filename);
+
+    for (int v = 0; v < n; v++) {
+        if (table.ids[v] != network.getInfo(v)) {
+            throw runtime_error("ERRO: " + filename + " não corresponde à rede carregada");
+        }
+    }
+    return table;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file ParkingTable.h
+ * @brief Precomputed walking times from the nearest parking nodes to every node
+ */
+#ifndef PARKING_TABLE_H
+#define PARKING_TABLE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include "../CsrGraph.h"
+
+/**
+ * @class ParkingTable
+ * @brief For every node, the K parking nodes with the shortest walk to it
+ *
+ * Built once with a multi-source Dijkstra over the walking weights, starting
+ * from every parking node, and saved to disk so later runs only load it.
+ * Hybrid queries use it to find the parking nodes within MaxWalkTime of the
+ * destination without running a walking search.
+ */
+class ParkingTable {
+public:
+    /**
+     * @brief One parking node and its walking time to the node it is listed under
+     */
+    struct Entry {
+        int parking;    // dense index in the network
+        int walkTime;
+    };
+
+    ParkingTable() = default;
+
+    /**
+     * @brief Builds the table
+     * @param network CSR network of the roads
+     * @param parkingData Map of parking availability (node ID -> isParking)
+     * @param k Number of parking nodes kept per node
+     */
+    static ParkingTable build(const CsrGraph<int>& network,
+                              const std::unordered_map<int, bool>& parkingData, int k);
+
+    /**
+     * @brief Writes the table to a binary file
+     * @throw runtime_error If the file cannot be written
+     * @note Written under a temporary name and renamed over filename (see AtomicFile)
+     */
+    void save(const std::string& filename) const;
+
+    /**
+     * @brief Reads a table written by save
+     * @param network Network the table must belong to
+     * @param parkingData Parking nodes the table must have been built with
+     * @throw runtime_error If the file cannot be read or was built for another
+     *        network (other nodes, edges or weights) or other parking nodes
+     */
+    static ParkingTable load(const std::string& filename, const CsrGraph<int>& network,
+                             const std::unordered_map<int, bool>& parkingData);
+
+    int getK() const { return k; }
+
+    /**
+     * @brief Parking nodes of v by increasing walking time (at most K)
+     */
+    const Entry* begin(int v) const { return &entries[(size_t) v * k]; }
+    const Entry* end(int v) const { return begin(v) + sizes[v]; }
+
+    /**
+     * @brief Whether every parking node within maxWalkTime of v is listed
+     * @note False when all K slots are used and the last one is still within reach
+     */
+    bool isComplete(int v, int maxWalkTime) const {
+        return sizes[v] < k || entries[(size_t) v * k + k - 1].walkTime > maxWalkTime;
+    }
+
+private:
+    int k = 0;
+    uint64_t fingerprint = 0;       // of the network and parking nodes it was built for
+    std::vector<int> ids;           // node ID of every dense index, to validate on load
+    std::vector<int> sizes;         // number of used slots per node
+    std::vector<Entry> entries;     // k slots per node
+
+    /*
+     * CsrGraph::getFingerprint combined with the parking flag of every node.
+     */
+    static uint64_t getFingerprint(const CsrGraph<int>& network, const std::unordered_map<int, bool>& parkingData);
+};
+
+#endif // PARKING_TABLE_H
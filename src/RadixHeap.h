@@ -0,0 +1,139 @@
+/*
+ * RadixHeap.h
+ * Radix heap: a monotone priority queue for integer keys.
+ */
+
+#ifndef DA_TP_CLASSES_RADIXHEAP
+#define DA_TP_CLASSES_RADIXHEAP
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <climits>
+
+/**
+ * class T must have: (i) accessible field int queueIndex; (ii) a non-negative,
+ * integer valued field dist, used as the key.
+ *
+ * Keys must never be smaller than the last key extracted (true for Dijkstra,
+ * and for A* with a consistent heuristic). Bucket i holds the keys whose
+ * highest bit differing from the last extracted key is bit i-1, so every
+ * entry is moved at most 32 times. decreaseKey leaves the old entry behind;
+ * it is skipped when found.
+*/
+
+template <class T>
+class RadixHeap {
+    std::vector<std::pair<unsigned, T *>> buckets[33];
+    unsigned last = 0;      // last extracted key
+    size_t count = 0;       // entries, including the outdated ones
+    static unsigned bucketOf(unsigned key, unsigned last);
+    static bool isLive(const std::pair<unsigned, T *> &entry);
+    bool advance();
+public:
+    void insert(T * x);
+    T * extractMin();
+    T * top();
+    void decreaseKey(T * x);
+    bool empty();
+    void clear();
+};
+
+template <class T>
+unsigned RadixHeap<T>::bucketOf(unsigned key, unsigned last) {
+    unsigned diff = key ^ last;
+    if (diff == 0) return 0;
+#if defined(__GNUC__)
+    return 32 - __builtin_clz(diff);
+#else
+    unsigned bits = 0;
+    for (; diff != 0; diff >>= 1) bits++;
+    return bits;
+#endif
+}
+
+template <class T>
+bool RadixHeap<T>::isLive(const std::pair<unsigned, T *> &entry) {
+    return entry.second->queueIndex != 0 && entry.first == (unsigned) entry.second->dist;
+}
+
+/*
+ * Makes bucket 0 end with the smallest live entry, redistributing the first
+ * non-empty bucket around its minimum. Returns false if there is none.
+ */
+template <class T>
+bool RadixHeap<T>::advance() {
+    while (count > 0) {
+        auto &first = buckets[0];
+        while (!first.empty()) {
+            if (isLive(first.back()))
+                return true;
+            first.pop_back();
+            count--;
+        }
+
+        unsigned i = 1;
+        while (buckets[i].empty()) i++;
+
+        unsigned minKey = UINT_MAX;
+        for (auto &entry : buckets[i])
+            if (isLive(entry) && entry.first < minKey) minKey = entry.first;
+
+        std::vector<std::pair<unsigned, T *>> entries;
+        entries.swap(buckets[i]);
+        if (minKey != UINT_MAX) last = minKey;
+        for (auto &entry : entries) {
+            if (isLive(entry))
+                buckets[bucketOf(entry.first, last)].push_back(entry);
+            else
+                count--;
+        }
+        entries.clear();
+        entries.swap(buckets[i]);   // keep the capacity for the next time
+    }
+    return false;
+}
+
+template <class T>
+bool RadixHeap<T>::empty() {
+    return !advance();
+}
+
+template <class T>
+void RadixHeap<T>::clear() {
+    if (count > 0)
+        for (auto &bucket : buckets) bucket.clear();
+    count = 0;
+    last = 0;
+}
+
+template <class T>
+T* RadixHeap<T>::extractMin() {
+    advance();
+    T *x = buckets[0].back().second;
+    buckets[0].pop_back();
+    count--;
+    x->queueIndex = 0;
+    return x;
+}
+
+template <class T>
+T* RadixHeap<T>::top() {
+    advance();
+    return buckets[0].back().second;
+}
+
+template <class T>
+void RadixHeap<T>::insert(T *x) {
+    unsigned key = x->dist;
+    buckets[bucketOf(key, last)].emplace_back(key, x);
+    count++;
+    x->queueIndex = 1;
+}
+
+template <class T>
+void RadixHeap<T>::decreaseKey(T *x) {
+    insert(x);
+}
+
+#endif /* DA_TP_CLASSES_RADIXHEAP */
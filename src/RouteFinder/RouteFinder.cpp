@@ -4,81 +4,674 @@
 #include <climits>
 #include <vector>
 #include <tuple>
+#include <type_traits>
+#include <queue>
+#include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include "../Graph.h"
+#include "../CsrGraph.h"
 
 using namespace std;
 
-bool RouteFinder::dijkstra(Graph<int>& roadNetwork, int start, int end, vector<int>& path, int& total_time, bool driving = true) {
-    Vertex<int>* startVertex = roadNetwork.findVertex(start);
-    Vertex<int>* endVertex = roadNetwork.findVertex(end);
-    if (!startVertex || !endVertex) return false;
+bool RouteFinder::dijkstra(const Graph<int>& roadNetwork, int start, int end, vector<int>& path, int& total_time, bool driving = true) {
+    CsrGraph<int> network(roadNetwork);
+    SearchContext context(network.getNumVertex());
+    return dijkstra(network, context, start, end, path, total_time, driving);
+}
+
+namespace {
+    /*
+     * One Dijkstra search advanced a vertex at a time. A reverse search follows
+     * incoming edges, so dist is the time *to* the source and path points to
+     * the next vertex towards it.
+     *
+     * With landmarks (or exact times toGoal) the search is A* towards goal,
+     * run as Dijkstra over the reduced weights w(u,v) + h(v) - h(u): dist is
+     * then the time from the source plus h(v) - h(source).
+     *
+     * Queue is one of the BasicSearchContext<W> queues; all the distance
+     * arithmetic is done in W, the weight type of the network.
+     */
+    template <class Queue, class W = int>
+    struct DijkstraSearch {
+        using Context = BasicSearchContext<W>;
+
+        const CsrGraph<int, W>& network;
+        Context& context;
+        bool driving, reverse;
+        const SearchOverlay& overlay;
+        const Landmarks* landmarks = nullptr;
+        int goal = -1;
+        const W* toGoal = nullptr;      // per vertex, UNREACHABLE if goal cannot be reached
+
+        void start(int sourceIdx) {
+            context.reset(network.getNumVertex());
+            if (overlay.isBlocked(sourceIdx)) return;
+            context[sourceIdx].dist = 0;
+            context.template queue<Queue>().insert(&context[sourceIdx]);
+        }
+
+        bool empty() { return context.template queue<Queue>().empty(); }
+        W topDist() { return context.template queue<Queue>().top()->dist; }
+
+        /*
+         * Settles the closest vertex and relaxes its edges. With another search
+         * running the opposite way, every edge leading into a vertex it has
+         * labelled is offered as a meeting point: best/meetFrom/meetTo keep
+         * the shortest one (meetFrom on this side, meetTo on the other).
+         */
+        int step(DijkstraSearch* other = nullptr, W* best = nullptr, int* meetFrom = nullptr, int* meetTo = nullptr) {
+            auto& pq = context.template queue<Queue>();
+            typename Context::Node* current = pq.extractMin();
+            int u = context.indexOf(current);
+            current->visited = true;
+            context.countSettled();
+            W potential = landmarks != nullptr ? landmarks->lowerBound(u, goal, driving)
+                        : toGoal != nullptr ? toGoal[u] : 0;
+
+            auto relax = [&](int v, int e) {
+                // Se for driving, ignora arestas não dirigíveis
+                if (driving && network.getWeight(e) < 0) return;
+                if (overlay.isBlocked(v) || (reverse ? overlay.isBlocked(v, u) : overlay.isBlocked(u, v))) return;
 
-    for (auto v : roadNetwork.getVertexSet()) {
-        v->setDist(INF);
-        v->setPath(nullptr);
-        v->setVisited(false);
+                typename Context::Node& neighbor = context[v];
+                W weight = driving ? network.getWeight(e) : network.getWalkingWeight(e);
+                W newDist = current->dist + weight;
+                if (landmarks != nullptr) {
+                    int bound = landmarks->lowerBound(v, goal, driving);
+                    if (bound == Landmarks::UNREACHABLE) return;    // goal cannot be reached from v
+                    newDist += bound - potential;
+                } else if (toGoal != nullptr) {
+                    if (toGoal[v] == Context::UNREACHABLE) return;
+                    newDist += toGoal[v] - potential;
+                }
+
+                if (other != nullptr) {
+                    W otherDist = other->context[v].dist;
+                    if (otherDist != Context::UNREACHABLE && newDist + otherDist < *best) {
+                        *best = newDist + otherDist;
+                        *meetFrom = u;
+                        *meetTo = v;
+                    }
+                }
+
+                if (!neighbor.visited && newDist < neighbor.dist) {
+                    neighbor.dist = newDist;
+                    neighbor.path = u;
+
+                    if (neighbor.queueIndex == 0) {
+                        pq.insert(&neighbor);
+                    } else {
+                        pq.decreaseKey(&neighbor);
+                    }
+                }
+            };
+
+            if (reverse) {
+                for (int i = network.incomingBegin(u); i < network.incomingEnd(u); i++) {
+                    int e = network.getIncomingEdge(i);
+                    relax(network.getOrig(e), e);
+                }
+            } else {
+                for (int e = network.edgesBegin(u); e < network.edgesEnd(u); e++) {
+                    relax(network.getDest(e), e);
+                }
+            }
+            return u;
+        }
+    };
+
+    template <class Queue, class W>
+    void runSearch(const CsrGraph<int, W>& network, BasicSearchContext<W>& context, int sourceIdx, int targetIdx,
+                   bool driving, bool reverse, const SearchOverlay& overlay, const Landmarks* landmarks) {
+        DijkstraSearch<Queue, W> search{network, context, driving, reverse, overlay, landmarks, targetIdx};
+        auto& pq = context.template queue<Queue>();
+        search.start(sourceIdx);
+        while (!search.empty()) {
+            // the target is settled before its edges are relaxed
+            if (targetIdx != -1 && pq.top() == &search.context[targetIdx]) {
+                pq.extractMin()->visited = true;
+                search.context.countSettled();
+                break;
+            }
+            search.step();
+        }
     }
 
-    MutablePriorityQueue<Vertex<int>> pq;
-    unordered_set<Vertex<int>*> inQueue;
+    /*
+     * Queue for QueuePolicy::Auto. Dial's buckets pay off when the weights
+     * are small next to the number of vertices; A* keys grow by the reduced
+     * weights, which have no such bound, so it uses the radix heap. So do
+     * searches over large weights: its keys only need to be monotone, and
+     * it beats every comparison heap (RouteBenchmark heap and queues).
+     */
+    QueuePolicy chooseQueue(const CsrGraph<int>& network, bool driving, const Landmarks* landmarks) {
+        if (landmarks != nullptr) return QueuePolicy::Radix;
+        int maxWeight = driving ? network.getMaxWeight() : network.getMaxWalkingWeight();
+        if (maxWeight <= network.getNumVertex()) return QueuePolicy::Dial;
+        return QueuePolicy::Radix;
+    }
 
-    startVertex->setDist(0);
-    pq.insert(startVertex);
-    inQueue.insert(startVertex);
+    template <class Queue>
+    struct QueueTag { using type = Queue; };
 
-    while (!pq.empty()) {
-        Vertex<int>* current = pq.extractMin();
-        inQueue.erase(current);
-        current->setVisited(true);
+    /*
+     * Calls run(QueueTag<Queue>()) with the queue chosen by the context
+     * policy for a search over driving or walking weights.
+     */
+    template <class F>
+    void withQueue(const CsrGraph<int>& network, const SearchContext& context, bool driving,
+                   const Landmarks* landmarks, F&& run) {
+        QueuePolicy policy = context.getQueuePolicy();
+        if (policy == QueuePolicy::Auto) policy = chooseQueue(network, driving, landmarks);
+
+        switch (policy) {
+            case QueuePolicy::QuaternaryHeap: run(QueueTag<SearchContext::QuaternaryHeap>()); break;
+            case QueuePolicy::Dial:
+                if (landmarks == nullptr) {
+                    run(QueueTag<SearchContext::DialQueue>());
+                    break;
+                }
+                // A* keys are not within maxWeight of each other
+                [[fallthrough]];
+            case QueuePolicy::Radix: run(QueueTag<SearchContext::RadixQueue>()); break;
+            case QueuePolicy::DaryHeap4: run(QueueTag<SearchContext::DaryHeap4>()); break;
+            case QueuePolicy::DaryHeap8: run(QueueTag<SearchContext::DaryHeap8>()); break;
+            case QueuePolicy::LazyDaryHeap4: run(QueueTag<SearchContext::LazyDaryHeap4>()); break;
+            case QueuePolicy::LazyDaryHeap8: run(QueueTag<SearchContext::LazyDaryHeap8>()); break;
+            default: run(QueueTag<SearchContext::BinaryHeap>()); break;
+        }
+    }
+
+    /*
+     * Sizes the buckets of Dial's queue for the weights a search will use
+     * (no-op for the other queues).
+     */
+    template <class Queue>
+    void prepareQueue(const CsrGraph<int>& network, SearchContext& context, bool driving) {
+        if constexpr (is_same_v<Queue, SearchContext::DialQueue>) {
+            int maxWeight = driving ? network.getMaxWeight() : network.getMaxWalkingWeight();
+            context.queue<SearchContext::DialQueue>().setMaxWeight(maxWeight);
+        }
+    }
+
+    /*
+     * Dijkstra from sourceIdx until targetIdx is settled (-1 settles every
+     * reachable vertex), or A* if landmarks are given, with the queue chosen
+     * by the context policy.
+     */
+    void runDijkstra(const CsrGraph<int>& network, SearchContext& context, int sourceIdx, int targetIdx,
+                     bool driving, bool reverse, const SearchOverlay& overlay,
+                     const Landmarks* landmarks = nullptr) {
+        withQueue(network, context, driving, landmarks, [&](auto tag) {
+            using Queue = typename decltype(tag)::type;
+            prepareQueue<Queue>(network, context, driving);
+            runSearch<Queue>(network, context, sourceIdx, targetIdx, driving, reverse, overlay, landmarks);
+        });
+    }
+
+    /*
+     * Workspace for the searches a ThreadPool worker runs on behalf of a
+     * query, with the queue policy of the query's context; reused by every
+     * later query the worker helps with.
+     */
+    SearchContext& workerContext(const SearchContext& like) {
+        thread_local SearchContext context;
+        context.setQueuePolicy(like.getQueuePolicy());
+        context.setHybridEngine(like.getHybridEngine());
+        return context;
+    }
+
+    /*
+     * Workspace for the backward half of a bidirectional search whose forward
+     * half runs on forward (a workerContext or a caller's, never this one).
+     */
+    SearchContext& backwardContext(const SearchContext& forward) {
+        thread_local SearchContext context;
+        context.setQueuePolicy(forward.getQueuePolicy());
+        return context;
+    }
+
+    /*
+     * Runs task(0, context) and task(1, other workspace), on two workers of
+     * the pool if there is one.
+     */
+    template <class F>
+    void runPair(ThreadPool* pool, SearchContext& context, F&& task) {
+        if (pool == nullptr) {
+            task(0, context);
+            task(1, context);
+            return;
+        }
+        pool->parallelFor(2, [&](int i, unsigned) { task(i, i == 0 ? context : workerContext(context)); });
+    }
+}
+
+bool RouteFinder::dijkstra(const CsrGraph<int>& network, SearchContext& context, int start, int end, vector<int>& path, int& total_time, bool driving,
+                           const SearchOverlay& overlay, const ContractionHierarchy* hierarchy,
+                           const Landmarks* landmarks) {
+    int startIdx = network.findVertexIdx(start);
+    int endIdx = network.findVertexIdx(end);
+    if (startIdx == -1 || endIdx == -1) return false;
+    if (overlay.isBlocked(startIdx) || overlay.isBlocked(endIdx)) return false;
 
-        if (current == endVertex) break;
+    // The hierarchy has no notion of avoided nodes/segments
+    if (driving && hierarchy != nullptr && overlay.empty()) {
+        vector<int> route;
+        if (!hierarchy->query(context, startIdx, endIdx, route, total_time)) return false;
+        path.clear();
+        for (int v : route) path.push_back(network.getInfo(v));
+        return true;
+    }
 
-        for (Edge<int>* edge : current->getAdj()) {
-            Vertex<int>* neighbor = edge->getDest();
+    if (landmarks != nullptr && landmarks->lowerBound(startIdx, endIdx, driving) == Landmarks::UNREACHABLE) return false;
+    runDijkstra(network, context, startIdx, endIdx, driving, false, overlay, landmarks);
 
-            // Se for driving, ignora arestas não dirigíveis
-            if (driving && edge->getWeight() < 0) continue;
+    if (context[endIdx].dist == SearchContext::UNREACHABLE) return false;
 
-            int weight = driving ? edge->getWeight() : edge->getWalkingWeight();
-            int newDist;
-            if (current->getDist() > INF - weight) {
-                newDist = INF; // Evita overflow
+    total_time = context[endIdx].dist;
+    if (landmarks != nullptr) total_time += landmarks->lowerBound(startIdx, endIdx, driving);
+    path.clear();
+    for (int v = endIdx; v != -1; v = context[v].path) {
+        path.push_back(network.getInfo(v));
+    }
+    reverse(path.begin(), path.end());
+    return true;
+}
+
+bool RouteFinder::bidirectionalDijkstra(const CsrGraph<int>& network, SearchContext& forwardContext,
+                                        SearchContext& backwardContext, int start, int end,
+                                        vector<int>& path, int& total_time, bool driving,
+                                        const SearchOverlay& overlay) {
+    int startIdx = network.findVertexIdx(start);
+    int endIdx = network.findVertexIdx(end);
+    if (startIdx == -1 || endIdx == -1) return false;
+    if (overlay.isBlocked(startIdx) || overlay.isBlocked(endIdx)) return false;
+
+    if (startIdx == endIdx) {
+        total_time = 0;
+        path.assign(1, start);
+        return true;
+    }
+
+    // Best path so far goes start -> meetForward -> meetBackward -> end
+    int best = SearchContext::UNREACHABLE;
+    int meetForward = -1, meetBackward = -1;
+
+    // Both searches use the queue the forward context's policy picks
+    withQueue(network, forwardContext, driving, nullptr, [&](auto tag) {
+        using Queue = typename decltype(tag)::type;
+        prepareQueue<Queue>(network, forwardContext, driving);
+        prepareQueue<Queue>(network, backwardContext, driving);
+        DijkstraSearch<Queue> forward{network, forwardContext, driving, false, overlay};
+        DijkstraSearch<Queue> backward{network, backwardContext, driving, true, overlay};
+        forward.start(startIdx);
+        backward.start(endIdx);
+
+        // Once the two closest unsettled vertices are at least as far as the best
+        // path found, no shorter path can still be found
+        while (!forward.empty() && !backward.empty() && forward.topDist() + backward.topDist() < best) {
+            if (forward.topDist() <= backward.topDist()) {
+                forward.step(&backward, &best, &meetForward, &meetBackward);
             } else {
-                newDist = current->getDist() + weight;
+                backward.step(&forward, &best, &meetBackward, &meetForward);
+            }
+        }
+    });
+
+    if (best == SearchContext::UNREACHABLE) return false;
+
+    total_time = best;
+    path.clear();
+    for (int v = meetForward; v != -1; v = forwardContext[v].path) {
+        path.push_back(network.getInfo(v));
+    }
+    reverse(path.begin(), path.end());
+    for (int v = meetBackward; v != -1; v = backwardContext[v].path) {
+        path.push_back(network.getInfo(v));
+    }
+    return true;
+}
+
+bool RouteFinder::shortestPathTree(const CsrGraph<int>& network, SearchContext& context, int root,
+                                   bool driving, bool reverse, const SearchOverlay& overlay) {
+    int rootIdx = network.findVertexIdx(root);
+    if (rootIdx == -1) return false;
+    runDijkstra(network, context, rootIdx, -1, driving, reverse, overlay);
+    return !overlay.isBlocked(rootIdx);
+}
+
+namespace {
+    /*
+     * Time of the fastest usable edge u->v, UNREACHABLE if there is none.
+     */
+    int edgeTime(const CsrGraph<int>& network, int u, int v, bool driving, const SearchOverlay& overlay) {
+        int best = SearchContext::UNREACHABLE;
+        if (overlay.isBlocked(v) || overlay.isBlocked(u, v)) return best;
+        for (int e = network.edgesBegin(u); e < network.edgesEnd(u); e++) {
+            if (network.getDest(e) != v || (driving && network.getWeight(e) < 0)) continue;
+            best = min(best, driving ? network.getWeight(e) : network.getWalkingWeight(e));
+        }
+        return best;
+    }
+
+    uint64_t segmentKey(int u, int v) {
+        return (uint64_t(uint32_t(u)) << 32) | uint32_t(v);
+    }
+
+    /*
+     * A route by dense index, with the time from the start to every node of it.
+     */
+    struct TimedPath {
+        vector<int> nodes;
+        vector<int> times;
+    };
+
+    /*
+     * nodes with the times of their fastest usable edges; empty if a
+     * segment of it cannot be used.
+     */
+    TimedPath timedPath(const CsrGraph<int>& network, vector<int> nodes, bool driving, const SearchOverlay& overlay) {
+        TimedPath path{move(nodes), {0}};
+        for (size_t i = 1; i < path.nodes.size(); i++) {
+            int t = edgeTime(network, path.nodes[i - 1], path.nodes[i], driving, overlay);
+            if (t == SearchContext::UNREACHABLE) return TimedPath();
+            path.times.push_back(path.times.back() + t);
+        }
+        return path;
+    }
+
+    unordered_set<uint64_t> segmentsOf(const TimedPath& path) {
+        unordered_set<uint64_t> segments;
+        for (size_t i = 0; i + 1 < path.nodes.size(); i++) segments.insert(segmentKey(path.nodes[i], path.nodes[i + 1]));
+        return segments;
+    }
+
+    /*
+     * The known shortest route (node IDs) if it goes from startIdx to endIdx
+     * over usable segments, otherwise the route along nextHop (a tree towards endIdx).
+     */
+    TimedPath shortestRoute(const CsrGraph<int>& network, const vector<int>* shortest, int startIdx, int endIdx,
+                            const vector<int>& nextHop, bool driving, const SearchOverlay& overlay) {
+        TimedPath route;
+        if (shortest != nullptr && !shortest->empty()) {
+            vector<int> nodes;
+            for (int id : *shortest) nodes.push_back(network.findVertexIdx(id));
+            if (nodes.front() == startIdx && nodes.back() == endIdx && find(nodes.begin(), nodes.end(), -1) == nodes.end())
+                route = timedPath(network, move(nodes), driving, overlay);
+        }
+        if (route.nodes.empty()) {
+            vector<int> nodes;
+            for (int v = startIdx; v != -1; v = nextHop[v]) nodes.push_back(v);
+            route = timedPath(network, move(nodes), driving, overlay);
+        }
+        return route;
+    }
+
+    /*
+     * Whether path spends more than maxOverlap of its time, or of its segments,
+     * on the segments of one of the better routes. Counting segments keeps out
+     * a route that only swaps one long segment of a better one for a detour.
+     */
+    bool overlapsTooMuch(const TimedPath& path, const vector<unordered_set<uint64_t>>& better, double maxOverlap) {
+        int total = path.times.back();
+        int numSegments = (int) path.nodes.size() - 1;
+        for (const auto& segments : better) {
+            int sharedTime = 0, sharedSegments = 0;
+            for (size_t i = 0; i + 1 < path.nodes.size(); i++) {
+                if (segments.count(segmentKey(path.nodes[i], path.nodes[i + 1]))) {
+                    sharedTime += path.times[i + 1] - path.times[i];
+                    sharedSegments++;
+                }
             }
+            if ((total > 0 && sharedTime > maxOverlap * total)
+                || (numSegments > 0 && sharedSegments > maxOverlap * numSegments)) return true;
+        }
+        return false;
+    }
+}
+
+bool RouteFinder::kShortestPaths(const CsrGraph<int>& network, SearchContext& context, int start, int end,
+                                 int k, vector<pair<vector<int>, int>>& routes, bool driving, double maxOverlap,
+                                 const SearchOverlay& overlay, const vector<int>* shortest) {
+    routes.clear();
+    int startIdx = network.findVertexIdx(start);
+    int endIdx = network.findVertexIdx(end);
+    if (startIdx == -1 || endIdx == -1 || k <= 0) return false;
+    if (overlay.isBlocked(startIdx) || overlay.isBlocked(endIdx)) return false;
+
+    // shortest-path tree towards end, shared by every spur search
+    int n = network.getNumVertex();
+    runDijkstra(network, context, endIdx, -1, driving, true, overlay);
+    vector<int> toGoal(n), nextHop(n);
+    for (int v = 0; v < n; v++) {
+        toGoal[v] = context[v].dist;
+        nextHop[v] = context[v].path;
+    }
+    if (toGoal[startIdx] == SearchContext::UNREACHABLE) return false;
 
-            if (!neighbor->isVisited() && newDist < neighbor->getDist()) {
-                neighbor->setDist(newDist);
-                neighbor->setPath(edge);
+    TimedPath first = shortestRoute(network, shortest, startIdx, endIdx, nextHop, driving, overlay);
+    vector<TimedPath> found{first};                 // Yen's list A
+    set<pair<int, vector<int>>> candidates;         // Yen's list B, by time
+    set<vector<int>> seen{first.nodes};
+    vector<unordered_set<uint64_t>> acceptedSegments;
+    int maxPaths = YEN_PATHS_PER_ROUTE * k;
 
-                if (inQueue.find(neighbor) == inQueue.end()) {
-                    pq.insert(neighbor);
-                    inQueue.insert(neighbor);
-                } else {
-                    pq.decreaseKey(neighbor);
+    while (true) {
+        // keep the newest route unless it mostly repeats a better one
+        const TimedPath& last = found.back();
+        int total = last.times.back();
+        if (!overlapsTooMuch(last, acceptedSegments, maxOverlap)) {
+            vector<int> ids;
+            for (int v : last.nodes) ids.push_back(network.getInfo(v));
+            routes.emplace_back(move(ids), total);
+            acceptedSegments.push_back(segmentsOf(last));
+        }
+        if ((int) routes.size() == k || (int) found.size() >= maxPaths) break;
+
+        // spur from every node of the newest route but the last
+        const TimedPath prev = found.back();
+        for (size_t i = 0; i + 1 < prev.nodes.size(); i++) {
+            int spur = prev.nodes[i];
+            SearchOverlay spurOverlay = overlay;
+            for (size_t j = 0; j < i; j++) spurOverlay.blockVertex(prev.nodes[j]);
+            for (const TimedPath& p : found) {
+                if (p.nodes.size() > i + 1 && equal(p.nodes.begin(), p.nodes.begin() + i + 1, prev.nodes.begin()))
+                    spurOverlay.blockEdge(p.nodes[i], p.nodes[i + 1]);
+            }
+
+            vector<int> spurPath;
+            int spurTime = SearchContext::UNREACHABLE;
+            bool treeUsable = true;
+            for (int v = spur; v != endIdx && treeUsable; v = nextHop[v]) {
+                int w = nextHop[v];
+                treeUsable = w != -1 && !spurOverlay.isBlocked(w) && !spurOverlay.isBlocked(v, w);
+            }
+            if (treeUsable) {
+                for (int v = spur; v != -1; v = nextHop[v]) spurPath.push_back(v);
+                spurTime = toGoal[spur];
+            } else {
+                using Queue = SearchContext::RadixQueue;
+                DijkstraSearch<Queue> search{network, context, driving, false, spurOverlay, nullptr, endIdx,
+                                             toGoal.data()};
+                auto& pq = context.queue<Queue>();
+                search.start(spur);
+                while (!search.empty()) {
+                    if (pq.top() == &context[endIdx]) {
+                        pq.extractMin()->visited = true;
+                        break;
+                    }
+                    search.step();
                 }
+                if (!context[endIdx].visited) continue;
+                spurTime = context[endIdx].dist + toGoal[spur];
+                for (int v = endIdx; v != -1; v = context[v].path) spurPath.push_back(v);
+                reverse(spurPath.begin(), spurPath.end());
+            }
+
+            vector<int> nodes(prev.nodes.begin(), prev.nodes.begin() + i);
+            nodes.insert(nodes.end(), spurPath.begin(), spurPath.end());
+            if (!seen.count(nodes)) {
+                seen.insert(nodes);
+                candidates.emplace(prev.times[i] + spurTime, move(nodes));
             }
         }
+
+        if (candidates.empty()) break;
+        auto next = candidates.begin();
+        found.push_back(timedPath(network, next->second, driving, overlay));
+        candidates.erase(next);
     }
+    return true;
+}
 
-    if (endVertex->getDist() >= INF) return false;
+bool RouteFinder::viaNodeAlternatives(const CsrGraph<int>& network, SearchContext& context, int start, int end,
+                                      int k, vector<pair<vector<int>, int>>& routes, bool driving,
+                                      double maxStretch, double maxOverlap, double localOptimality,
+                                      const SearchOverlay& overlay, const vector<int>* shortest) {
+    routes.clear();
+    int startIdx = network.findVertexIdx(start);
+    int endIdx = network.findVertexIdx(end);
+    if (startIdx == -1 || endIdx == -1 || k <= 0) return false;
+    if (overlay.isBlocked(startIdx) || overlay.isBlocked(endIdx)) return false;
 
-    total_time = endVertex->getDist();
-    Vertex<int>* current = endVertex;
-    while (current != nullptr) {
-        path.push_back(current->getInfo());
-        current = current->getPath() ? current->getPath()->getOrig() : nullptr;
+    // tree from start and tree towards end
+    int n = network.getNumVertex();
+    vector<int> fromStart(n), previous(n), toEnd(n), nextHop(n);
+    runDijkstra(network, context, startIdx, -1, driving, false, overlay);
+    for (int v = 0; v < n; v++) {
+        fromStart[v] = context[v].dist;
+        previous[v] = context[v].path;
+    }
+    runDijkstra(network, context, endIdx, -1, driving, true, overlay);
+    for (int v = 0; v < n; v++) {
+        toEnd[v] = context[v].dist;
+        nextHop[v] = context[v].path;
+    }
+    int best = toEnd[startIdx];
+    if (best == SearchContext::UNREACHABLE) return false;
+
+    TimedPath first = shortestRoute(network, shortest, startIdx, endIdx, nextHop, driving, overlay);
+    vector<int> ids;
+    for (int v : first.nodes) ids.push_back(network.getInfo(v));
+    routes.emplace_back(move(ids), first.times.back());
+    vector<unordered_set<uint64_t>> acceptedSegments{segmentsOf(first)};
+    if (k == 1) return true;
+
+    // A plateau is a chain of edges u->w in both trees (previous[w] == u,
+    // nextHop[u] == w); before/after are the plateau times on each side of v
+    // and head the first node of its plateau
+    auto onPlateau = [&](int u, int w) { return u != -1 && w != -1 && previous[w] == u && nextHop[u] == w; };
+    vector<int> before(n, -1), after(n, -1), head(n, -1), chain;
+    auto plateauBefore = [&](int v) {
+        for (int u = v; before[u] == -1; u = previous[u]) {
+            chain.push_back(u);
+            if (!onPlateau(previous[u], u)) {
+                before[u] = 0;
+                head[u] = u;
+                break;
+            }
+        }
+        for (; !chain.empty(); chain.pop_back()) {
+            int u = chain.back();
+            if (before[u] != -1) continue;
+            before[u] = before[previous[u]] + fromStart[u] - fromStart[previous[u]];
+            head[u] = head[previous[u]];
+        }
+        return before[v];
+    };
+    auto plateauAfter = [&](int v) {
+        for (int u = v; after[u] == -1; u = nextHop[u]) {
+            chain.push_back(u);
+            if (!onPlateau(u, nextHop[u])) {
+                after[u] = 0;
+                break;
+            }
+        }
+        for (; !chain.empty(); chain.pop_back()) {
+            int u = chain.back();
+            if (after[u] == -1) after[u] = after[nextHop[u]] + toEnd[u] - toEnd[nextHop[u]];
+        }
+        return after[v];
+    };
+
+    // Candidates: one via node per plateau within the stretch, the one
+    // closest to its middle, ranked by 2 * time - plateau time
+    vector<bool> onShortest(n, false);
+    for (int v : first.nodes) onShortest[v] = true;
+    unordered_map<int, int> viaOfPlateau;       // first node of the plateau -> via node
+    for (int v = 0; v < n; v++) {
+        if (onShortest[v] || fromStart[v] == SearchContext::UNREACHABLE || toEnd[v] == SearchContext::UNREACHABLE) continue;
+        if (fromStart[v] + (long long) toEnd[v] > maxStretch * best) continue;
+        int b = plateauBefore(v), a = plateauAfter(v);
+        auto it = viaOfPlateau.emplace(head[v], v).first;
+        int w = it->second;
+        if (abs(b - a) < abs(before[w] - after[w])) it->second = v;
+    }
+    vector<pair<long long, int>> ranked;
+    for (const auto& [plateau, v] : viaOfPlateau) {
+        ranked.emplace_back(2LL * (fromStart[v] + toEnd[v]) - before[v] - after[v], v);
+    }
+    sort(ranked.begin(), ranked.end());
+
+    int window = (int) (localOptimality * best);
+    vector<int> stamp(n, -1);
+    int examined = 0;
+    for (const auto& [score, v] : ranked) {
+        if ((int) routes.size() == k || examined++ == VIA_CANDIDATES_PER_ROUTE * (k - 1)) break;
+
+        // start -> v on the first tree, v -> end on the second, without loops
+        vector<int> nodes;
+        for (int u = v; u != -1; u = previous[u]) nodes.push_back(u);
+        reverse(nodes.begin(), nodes.end());
+        size_t viaPos = nodes.size() - 1;
+        for (int u = nextHop[v]; u != -1; u = nextHop[u]) nodes.push_back(u);
+        bool loopless = true;
+        for (int u : nodes) {
+            if (stamp[u] == v) loopless = false;
+            stamp[u] = v;
+        }
+        if (!loopless) continue;
+        TimedPath route = timedPath(network, move(nodes), driving, overlay);
+        if (route.nodes.empty()) continue;
+
+        // limited sharing with every route already returned
+        int total = route.times.back();
+        if (overlapsTooMuch(route, acceptedSegments, maxOverlap)) continue;
+
+        // local optimality: the stretch of about window on each side of v
+        // must be a shortest path, which it is if the plateau covers it
+        size_t x = viaPos, y = viaPos;
+        while (x > 0 && route.times[viaPos] - route.times[x] < window) x--;
+        while (y + 1 < route.nodes.size() && route.times[y] - route.times[viaPos] < window) y++;
+        int span = route.times[y] - route.times[x];
+        if (route.times[viaPos] - route.times[x] > before[v] || route.times[y] - route.times[viaPos] > after[v]) {
+            runDijkstra(network, context, route.nodes[x], route.nodes[y], driving, false, overlay);
+            if (context[route.nodes[y]].dist < span) continue;
+        }
+
+        ids.clear();
+        for (int u : route.nodes) ids.push_back(network.getInfo(u));
+        routes.emplace_back(ids, total);
+        acceptedSegments.push_back(segmentsOf(route));
     }
-    reverse(path.begin(), path.end());
     return true;
 }
 
-bool RouteFinder::findRouteWithIncludeNode(Graph<int>& roadNetwork, int start, int end, int include,
+bool RouteFinder::findRouteWithIncludeNode(const Graph<int>& roadNetwork, int start, int end, int include,
                             vector<int>& path, int& total_time) {
+    CsrGraph<int> network(roadNetwork);
+    SearchContext context(network.getNumVertex());
+    return findRouteWithIncludeNode(network, context, start, end, include, path, total_time);
+}
+
+bool RouteFinder::findRouteWithIncludeNode(const CsrGraph<int>& network, SearchContext& context, int start, int end, int include,
+                            vector<int>& path, int& total_time, const SearchOverlay& overlay,
+                            const ContractionHierarchy* hierarchy, const Landmarks* landmarks) {
     vector<int> directPath;
     int directTime;
-    if (dijkstra(roadNetwork, start, end, directPath, directTime)) {
+    if (dijkstra(network, context, start, end, directPath, directTime, true, overlay, hierarchy, landmarks)) {
         if (find(directPath.begin(), directPath.end(), include) != directPath.end()) {
             path = directPath;
             total_time = directTime;
@@ -89,8 +682,8 @@ bool RouteFinder::findRouteWithIncludeNode(Graph<int>& roadNetwork, int start, i
     vector<int> firstLeg, secondLeg;
     int time1, time2;
 
-    if (!dijkstra(roadNetwork, start, include, firstLeg, time1) ||
-        !dijkstra(roadNetwork, include, end, secondLeg, time2)) {
+    if (!dijkstra(network, context, start, include, firstLeg, time1, true, overlay, hierarchy, landmarks) ||
+        !dijkstra(network, context, include, end, secondLeg, time2, true, overlay, hierarchy, landmarks)) {
         return false;
         }
 
@@ -100,8 +693,233 @@ bool RouteFinder::findRouteWithIncludeNode(Graph<int>& roadNetwork, int start, i
     return true;
 }
 
+bool RouteFinder::findRouteWithIncludeNodes(const CsrGraph<int>& network, SearchContext& context, int start, int end,
+                                            const vector<int>& include, vector<int>& path, int& total_time,
+                                            const SearchOverlay& overlay, const ContractionHierarchy* hierarchy,
+                                            const Landmarks* landmarks) {
+    vector<int> stops;
+    for (int id : include) {
+        if (id != start && id != end && find(stops.begin(), stops.end(), id) == stops.end()) stops.push_back(id);
+    }
+    if (stops.empty()) return dijkstra(network, context, start, end, path, total_time, true, overlay, hierarchy, landmarks);
+    if (stops.size() == 1) {
+        return findRouteWithIncludeNode(network, context, start, end, stops[0], path, total_time,
+                                        overlay, hierarchy, landmarks);
+    }
+
+    // start, the stops, end
+    vector<int> points{network.findVertexIdx(start)};
+    for (int id : stops) points.push_back(network.findVertexIdx(id));
+    points.push_back(network.findVertexIdx(end));
+    for (int v : points) {
+        if (v == -1 || overlay.isBlocked(v)) return false;
+    }
+
+    // times and routes from every point but end to every other one, one tree each
+    int m = points.size();
+    vector<vector<int>> times(m, vector<int>(m, SearchContext::UNREACHABLE));
+    vector<vector<vector<int>>> legs(m, vector<vector<int>>(m));
+    for (int i = 0; i + 1 < m; i++) {
+        runDijkstra(network, context, points[i], -1, true, false, overlay);
+        for (int j = 1; j < m; j++) {
+            if (j == i || context[points[j]].dist == SearchContext::UNREACHABLE) continue;
+            times[i][j] = context[points[j]].dist;
+            for (int v = points[j]; v != -1; v = context[v].path) legs[i][j].push_back(network.getInfo(v));
+            reverse(legs[i][j].begin(), legs[i][j].end());
+        }
+    }
+
+    vector<int> order;
+    long long time = orderStops(times, order, (int) stops.size() <= HELD_KARP_MAX_STOPS);
+    if (time == SearchContext::UNREACHABLE) return false;
+
+    order.insert(order.begin(), 0);
+    order.push_back(m - 1);
+    path.assign(1, start);
+    for (size_t k = 0; k + 1 < order.size(); k++) {
+        const vector<int>& leg = legs[order[k]][order[k + 1]];
+        path.insert(path.end(), leg.begin() + 1, leg.end());
+    }
+    total_time = time;
+    return true;
+}
+
+namespace {
+    const long long NO_ROUTE = LLONG_MAX / 4;
+
+    /*
+     * Time from point 0 through the stops of order to the last point.
+     */
+    long long routeTime(const vector<vector<int>>& times, const vector<int>& order) {
+        long long total = 0;
+        int last = times.size() - 1;
+        for (size_t k = 0; k <= order.size(); k++) {
+            int from = k == 0 ? 0 : order[k - 1];
+            int to = k == order.size() ? last : order[k];
+            if (times[from][to] == SearchContext::UNREACHABLE) return NO_ROUTE;
+            total += times[from][to];
+        }
+        return total;
+    }
+
+    /*
+     * Held-Karp over the subsets of stops: best[mask][j] is the fastest
+     * route from the start through the stops of mask, ending at stop j.
+     */
+    long long orderExact(const vector<vector<int>>& times, vector<int>& order) {
+        int s = times.size() - 2, last = s + 1;
+        auto time = [&](int from, int to) {
+            return times[from][to] == SearchContext::UNREACHABLE ? NO_ROUTE : (long long) times[from][to];
+        };
+        // by mask * s + j
+        vector<long long> best((size_t(1) << s) * s, NO_ROUTE);
+        vector<int> before(best.size(), -1);
+        for (int j = 0; j < s; j++) best[(size_t(1) << j) * s + j] = time(0, j + 1);
+        for (int mask = 1; mask < (1 << s); mask++) {
+            for (int j = 0; j < s; j++) {
+                long long here = best[size_t(mask) * s + j];
+                if (!(mask & (1 << j)) || here >= NO_ROUTE) continue;
+                for (int k = 0; k < s; k++) {
+                    if (mask & (1 << k)) continue;
+                    long long t = here + time(j + 1, k + 1);
+                    size_t next = size_t(mask | (1 << k)) * s + k;
+                    if (t < best[next]) {
+                        best[next] = t;
+                        before[next] = j;
+                    }
+                }
+            }
+        }
+
+        int full = (1 << s) - 1, j = -1;
+        long long total = NO_ROUTE;
+        for (int k = 0; k < s; k++) {
+            if (best[size_t(full) * s + k] >= NO_ROUTE) continue;
+            long long t = best[size_t(full) * s + k] + time(k + 1, last);
+            if (t < total) {
+                total = t;
+                j = k;
+            }
+        }
+        order.clear();
+        if (j == -1) return NO_ROUTE;
+        for (int mask = full; j != -1; ) {
+            order.push_back(j + 1);
+            int prev = before[size_t(mask) * s + j];
+            mask &= ~(1 << j);
+            j = prev;
+        }
+        reverse(order.begin(), order.end());
+        return total;
+    }
+
+    /*
+     * Nearest neighbour from the start, then 2-opt (reversing a run of
+     * stops) and Or-opt (moving a run of up to 3 stops elsewhere) while
+     * either shortens the route. Every move is checked on the whole route,
+     * so the times need not be symmetric.
+     */
+    long long orderHeuristic(const vector<vector<int>>& times, vector<int>& order) {
+        int s = times.size() - 2;
+        order.clear();
+        vector<bool> visited(s + 1, false);
+        for (int from = 0; (int) order.size() < s; ) {
+            int next = -1;
+            for (int k = 1; k <= s; k++) {
+                if (visited[k]) continue;
+                if (next == -1 || (long long) times[from][k] < times[from][next]) next = k;
+            }
+            visited[next] = true;
+            order.push_back(next);
+            from = next;
+        }
+
+        long long total = routeTime(times, order);
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            for (int i = 0; i < s; i++) {
+                for (int j = i + 1; j < s; j++) {
+                    reverse(order.begin() + i, order.begin() + j + 1);
+                    long long t = routeTime(times, order);
+                    if (t < total) {
+                        total = t;
+                        improved = true;
+                    } else {
+                        reverse(order.begin() + i, order.begin() + j + 1);
+                    }
+                }
+            }
+            for (int len = 1; len <= 3 && len < s; len++) {
+                for (int i = 0; i + len <= s; i++) {
+                    for (int p = 0; p + len <= s; p++) {
+                        if (p == i) continue;
+                        vector<int> moved = order;
+                        vector<int> run(moved.begin() + i, moved.begin() + i + len);
+                        moved.erase(moved.begin() + i, moved.begin() + i + len);
+                        moved.insert(moved.begin() + p, run.begin(), run.end());
+                        long long t = routeTime(times, moved);
+                        if (t < total) {
+                            total = t;
+                            order = move(moved);
+                            improved = true;
+                        }
+                    }
+                }
+            }
+        }
+        return total;
+    }
+}
+
+long long RouteFinder::orderStops(const vector<vector<int>>& times, vector<int>& order, bool exact) {
+    long long total;
+    if (times.size() <= 2) {
+        order.clear();
+        total = routeTime(times, order);
+    } else {
+        total = exact ? orderExact(times, order) : orderHeuristic(times, order);
+    }
+    return total >= NO_ROUTE ? SearchContext::UNREACHABLE : total;
+}
+
+void RouteFinder::collectParkingCandidates(const CsrGraph<int>& network, SearchContext& context,
+                    const unordered_map<int, bool>& parkingData, int start, int end,
+                    const SearchOverlay& overlay, vector<tuple<int, int, int>>& candidates,
+                    bool& hasDrivingRoute, bool& hasWalkingRoute, ThreadPool* pool) {
+    candidates.clear();
+    hasDrivingRoute = hasWalkingRoute = false;
+
+    vector<int> parking;    // dense indices
+    for (int v = 0; v < network.getNumVertex(); v++) {
+        if (!overlay.isBlocked(v) && parkingData.at(network.getInfo(v))) parking.push_back(v);
+    }
 
-bool RouteFinder::findHybridRoute(Graph<int>& roadNetwork, const unordered_map<int, bool>& parkingData,
+    // Driving times from start to every parking node, and walking times from
+    // every parking node to end on the reversed edges: independent trees
+    vector<int> driveTimes(parking.size()), walkTimes(parking.size());
+    runPair(pool, context, [&](int tree, SearchContext& treeContext) {
+        bool driving = tree == 0;
+        vector<int>& times = driving ? driveTimes : walkTimes;
+        bool rootOk = shortestPathTree(network, treeContext, driving ? start : end, driving, !driving, overlay);
+        for (size_t i = 0; i < parking.size(); i++) {
+            times[i] = rootOk ? treeContext[parking[i]].dist : SearchContext::UNREACHABLE;
+        }
+    });
+
+    for (size_t i = 0; i < parking.size(); i++) {
+        int v = parking[i], driveTime = driveTimes[i], walkTime = walkTimes[i];
+        if (driveTime != SearchContext::UNREACHABLE) hasDrivingRoute = true;
+        if (walkTime != SearchContext::UNREACHABLE) hasWalkingRoute = true;
+
+        int p = network.getInfo(v);
+        if (p == start || p == end || driveTime == SearchContext::UNREACHABLE
+            || walkTime == SearchContext::UNREACHABLE) continue;
+        candidates.emplace_back(p, driveTime, walkTime);
+    }
+}
+
+bool RouteFinder::findHybridRoute(const Graph<int>& roadNetwork, const unordered_map<int, bool>& parkingData,
                     int start, int end, int maxWalkTime,
                     const vector<int>& avoidNodes, const vector<pair<int, int>>& avoidSegments,
                     vector<int>& drivingRoute, vector<int>& walkingRoute,
@@ -114,36 +932,76 @@ bool RouteFinder::findHybridRoute(Graph<int>& roadNetwork, const unordered_map<i
         return false;
     }
 
-    // Create restricted graph with avoided nodes/segments
-    Graph<int> restrictedGraph = roadNetwork;
-    for (int node : avoidNodes) restrictedGraph.removeVertex(node);
-    for (auto& seg : avoidSegments) {
-        restrictedGraph.removeEdge(seg.first, seg.second);
-        restrictedGraph.removeEdge(seg.second, seg.first);
+    CsrGraph<int> network(roadNetwork);
+    SearchContext context(network.getNumVertex());
+    SearchOverlay overlay(network, avoidNodes, avoidSegments);
+    return findHybridRoute(network, context, parkingData, start, end, maxWalkTime, overlay,
+                           drivingRoute, walkingRoute, parkingNode, totalTime, message, alternatives);
+}
+
+bool RouteFinder::findHybridRoute(const CsrGraph<int>& network, SearchContext& context, const unordered_map<int, bool>& parkingData,
+                    int start, int end, int maxWalkTime, const SearchOverlay& overlay,
+                    vector<int>& drivingRoute, vector<int>& walkingRoute,
+                    int& parkingNode, int& totalTime, string& message,
+                    vector<tuple<int, vector<int>, vector<int>, int>>* alternatives,
+                    const ParkingTable* parkingTable, ThreadPool* pool) {
+
+    int startIdx = network.findVertexIdx(start);
+    int endIdx = network.findVertexIdx(end);
+    if (startIdx == -1 || endIdx == -1) {
+        message = "O no" + to_string(start) + " nao existe";
+        return false;
     }
 
-    vector<tuple<int, int, int>> validCandidates;  // Within walking time
-    vector<tuple<int, int, int>> allCandidates;    // All possible candidates
+    // Without a route within maxWalkTime, the trees below give the message and the alternatives
+    if (context.getHybridEngine() == HybridEngine::Layered
+        && layeredHybridRoute(network, context, parkingData, startIdx, endIdx, maxWalkTime, overlay,
+                              drivingRoute, walkingRoute, parkingNode, totalTime)) {
+        return true;
+    }
 
-    for (auto vertex : restrictedGraph.getVertexSet()) {
-        int p = vertex->getInfo();
+    // With the precomputed table (only valid without avoided nodes/segments),
+    // the parking nodes within walking time come from it instead of a walking search
+    if (parkingTable != nullptr && overlay.empty() && parkingTable->isComplete(endIdx, maxWalkTime)
+        && shortestPathTree(network, context, start, true, false)) {
+        int bestIdx = -1;
+        tuple<int, int, int> best;
+        for (auto e = parkingTable->begin(endIdx); e != parkingTable->end(endIdx); e++) {
+            int p = network.getInfo(e->parking);
+            int driveTime = context[e->parking].dist;
+            if (e->walkTime > maxWalkTime || p == start || p == end || driveTime == SearchContext::UNREACHABLE) continue;
 
-        // Skip if not a parking node or is start/end
-        if (p == start || p == end || !parkingData.at(p)) continue;
+            int total = driveTime + e->walkTime;
+            int bestTotal = get<1>(best) + get<2>(best);
+            // same tie-break as the search below: first parking node in network order
+            if (bestIdx == -1 || total < bestTotal || (total == bestTotal && e->parking < bestIdx)) {
+                bestIdx = e->parking;
+                best = make_tuple(p, driveTime, e->walkTime);
+            }
+        }
 
-        // Calculate driving path
-        vector<int> drivePath;
-        int driveTime;
-        if (!dijkstra(restrictedGraph, start, p, drivePath, driveTime, true)) continue;
+        if (bestIdx != -1) {
+            parkingNode = get<0>(best);
+            // The driving leg is already in the tree; only the walking leg needs a search
+            drivingRoute.clear();
+            for (int v = bestIdx; v != -1; v = context[v].path) drivingRoute.push_back(network.getInfo(v));
+            reverse(drivingRoute.begin(), drivingRoute.end());
+            bidirectionalDijkstra(network, context, backwardContext(context), parkingNode, end,
+                                  walkingRoute, get<2>(best), false, overlay);
+            totalTime = get<1>(best) + get<2>(best);
+            return true;
+        }
+    }
 
-        // Calculate walking path
-        vector<int> walkPath;
-        int walkTime;
-        if (!dijkstra(restrictedGraph, p, end, walkPath, walkTime, false)) continue;
+    vector<tuple<int, int, int>> validCandidates;  // Within walking time
+    vector<tuple<int, int, int>> allCandidates;    // All possible candidates
+    bool hasDrivingRoute, hasWalkingRoute;
 
-        allCandidates.emplace_back(p, driveTime, walkTime);
-        if (walkTime <= maxWalkTime) {
-            validCandidates.emplace_back(p, driveTime, walkTime);
+    collectParkingCandidates(network, context, parkingData, start, end, overlay,
+                             allCandidates, hasDrivingRoute, hasWalkingRoute, pool);
+    for (const auto& c : allCandidates) {
+        if (get<2>(c) <= maxWalkTime) {
+            validCandidates.push_back(c);
         }
     }
 
@@ -155,8 +1013,12 @@ bool RouteFinder::findHybridRoute(Graph<int>& roadNetwork, const unordered_map<i
             });
 
         parkingNode = get<0>(best);
-        dijkstra(restrictedGraph, start, parkingNode, drivingRoute, get<1>(best), true);
-        dijkstra(restrictedGraph, parkingNode, end, walkingRoute, get<2>(best), false);
+        runPair(pool, context, [&](int leg, SearchContext& legContext) {
+            if (leg == 0) bidirectionalDijkstra(network, legContext, backwardContext(legContext), start, parkingNode,
+                                                drivingRoute, get<1>(best), true, overlay);
+            else bidirectionalDijkstra(network, legContext, backwardContext(legContext), parkingNode, end,
+                                       walkingRoute, get<2>(best), false, overlay);
+        });
         totalTime = get<1>(best) + get<2>(best);
         return true;
     }
@@ -173,37 +1035,8 @@ bool RouteFinder::findHybridRoute(Graph<int>& roadNetwork, const unordered_map<i
         }
 
         // Check if driving route exists to any parking node
-        bool hasDrivingRoute = false;
-        for (auto& p : parkingData) {
-            if (p.second) {
-                vector<int> testPath;
-                int testTime;
-                if (dijkstra(restrictedGraph, start, p.first, testPath, testTime, true)) {
-                    hasDrivingRoute = true;
-                    break;
-                }
-            }
-        }
-
-        if (!hasDrivingRoute) {
-            message = "Nao existe rota sem estes segmentos/nos.";
-            return false;
-        }
-
-        // Check if walking route exists from any parking node
-        bool hasWalkingRoute = false;
-        for (auto& p : parkingData) {
-            if (p.second) {
-                vector<int> testPath;
-                int testTime;
-                if (dijkstra(restrictedGraph, p.first, end, testPath, testTime, false)) {
-                    hasWalkingRoute = true;
-                    break;
-                }
-            }
-        }
-
-        if (!hasWalkingRoute) {
+        // and if walking route exists from any parking node
+        if (!hasDrivingRoute || !hasWalkingRoute) {
             message = "Nao existe rota sem estes segmentos/nos.";
             return false;
         }
@@ -221,65 +1054,158 @@ bool RouteFinder::findHybridRoute(Graph<int>& roadNetwork, const unordered_map<i
 
     // If alternatives pointer was provided, find them
     if (alternatives != nullptr) {
-        *alternatives = findAlternativeRoutes(roadNetwork, parkingData, start, end, maxWalkTime,
-                                           avoidNodes, avoidSegments);
+        *alternatives = findAlternativeRoutes(network, context, parkingData, start, end, maxWalkTime, overlay, pool);
     }
 
     return false;
 }
 
 vector<tuple<int, vector<int>, vector<int>, int>> RouteFinder::findAlternativeRoutes(
-    Graph<int>& roadNetwork, const unordered_map<int, bool>& parkingData,
+    const Graph<int>& roadNetwork, const unordered_map<int, bool>& parkingData,
     int start, int end, int originalMaxWalkTime,
     const vector<int>& avoidNodes, const vector<pair<int, int>>& avoidSegments) {
 
+    CsrGraph<int> network(roadNetwork);
+    SearchContext context(network.getNumVertex());
+    SearchOverlay overlay(network, avoidNodes, avoidSegments);
+    return findAlternativeRoutes(network, context, parkingData, start, end, originalMaxWalkTime, overlay);
+}
+
+vector<tuple<int, vector<int>, vector<int>, int>> RouteFinder::findAlternativeRoutes(
+    const CsrGraph<int>& network, SearchContext& context,
+    const unordered_map<int, bool>& parkingData,
+    int start, int end, int originalMaxWalkTime, const SearchOverlay& overlay, ThreadPool* pool) {
+
     vector<tuple<int, vector<int>, vector<int>, int>> alternatives;
     vector<tuple<int, int, int>> allCandidates; // {parkingNode, driveTime, walkTime}
 
-    // Criar grafo restrito
-    Graph<int> restrictedGraph = roadNetwork;
-    for (int node : avoidNodes) restrictedGraph.removeVertex(node);
-    for (auto& seg : avoidSegments) {
-        restrictedGraph.removeEdge(seg.first, seg.second);
-        restrictedGraph.removeEdge(seg.second, seg.first);
+    // Coletar TODOS os candidatos possíveis, sem considerar maxWalkTime
+    bool hasDrivingRoute, hasWalkingRoute;
+    collectParkingCandidates(network, context, parkingData, start, end, overlay,
+                             allCandidates, hasDrivingRoute, hasWalkingRoute, pool);
+
+    sort(allCandidates.begin(), allCandidates.end(),
+        [](const auto& a, const auto& b) {
+            return (get<1>(a) + get<2>(a)) < (get<1>(b) + get<2>(b));
+        });
+
+    // Legs of the two best candidates; with a pool, each search writes its own slot
+    int count = min(2, (int)allCandidates.size());
+    vector<vector<int>> paths(2 * count);
+    vector<int> times(2 * count);
+    auto leg = [&](int i, SearchContext& legContext) {
+        int p = get<0>(allCandidates[i / 2]);
+        SearchContext& backward = backwardContext(legContext);
+        if (i % 2 == 0) bidirectionalDijkstra(network, legContext, backward, start, p, paths[i], times[i], true, overlay);
+        else bidirectionalDijkstra(network, legContext, backward, p, end, paths[i], times[i], false, overlay);
+    };
+    if (pool == nullptr) {
+        for (int i = 0; i < 2 * count; i++) leg(i, context);
+    } else {
+        pool->parallelFor(2 * count, [&](int i, unsigned) { leg(i, i == 0 ? context : workerContext(context)); });
+    }
+
+    for (int i = 0; i < count; i++) {
+        alternatives.emplace_back(get<0>(allCandidates[i]), paths[2 * i], paths[2 * i + 1],
+                                  times[2 * i] + times[2 * i + 1]);
     }
 
-    // Coletar TODOS os candidatos possíveis, sem considerar maxWalkTime
-    for (auto vertex : restrictedGraph.getVertexSet()) {
-        int p = vertex->getInfo();
+    return alternatives;
+}
+
+bool RouteFinder::layeredHybridRoute(const CsrGraph<int>& network, SearchContext& context,
+                    const unordered_map<int, bool>& parkingData,
+                    int startIdx, int endIdx, int maxWalkTime, const SearchOverlay& overlay,
+                    vector<int>& drivingRoute, vector<int>& walkingRoute,
+                    int& parkingNode, int& totalTime) {
 
-        // Verificar se é um nó de estacionamento válido
-        if (p == start || p == end || !parkingData.at(p))
-            continue;
+    // Label = estado (no, camada) com tempo total (chave) e tempo a pe acumulado
+    using Label = SearchContext::Label;
+    enum { DRIVING, WALKING };
 
-        vector<int> drivePath;
-        int driveTime;
-        if (!dijkstra(restrictedGraph, start, p, drivePath, driveTime, true)) continue;
+    // Driving layer: one label per node, nodes [0, n) of the context hold its
+    // distance and settled flag. Walking layer: labels are popped by increasing
+    // total, so a new one is only useful if it walks less than every label
+    // already settled on that node, kept as the dist of node n + v.
+    int n = network.getNumVertex();
+    context.reset(2 * n);
+    vector<Label>& labels = context.labels();
+    auto& pq = context.labelQueue();
+    greater<tuple<int, int, int>> later;
 
-        vector<int> walkPath;
-        int walkTime;
-        if (!dijkstra(restrictedGraph, p, end, walkPath, walkTime, false)) continue;
+    auto push = [&](int v, int layer, int total, int walk, int previous) {
+        labels.push_back({v, layer, total, walk, previous});
+        pq.emplace_back(total, walk, labels.size() - 1);
+        push_heap(pq.begin(), pq.end(), later);
+    };
 
-        allCandidates.emplace_back(p, driveTime, walkTime);
+    if (!overlay.isBlocked(startIdx) && !overlay.isBlocked(endIdx)) {
+        context[startIdx].dist = 0;
+        push(startIdx, DRIVING, 0, 0, -1);
     }
 
-    sort(allCandidates.begin(), allCandidates.end(),
-        [](const auto& a, const auto& b) {
-            return (get<1>(a) + get<2>(a)) < (get<1>(b) + get<2>(b));
-        });
+    int found = -1;
+    while (!pq.empty()) {
+        pop_heap(pq.begin(), pq.end(), later);
+        int l = get<2>(pq.back());
+        pq.pop_back();
+        Label cur = labels[l];
+        int u = cur.node;
 
-    for (int i = 0; i < min(2, (int)allCandidates.size()); i++) {
-        auto& candidate = allCandidates[i];
-        int p = get<0>(candidate);
-        vector<int> drivePath, walkPath;
-        int driveTime, walkTime;
+        if (cur.layer == DRIVING) {
+            if (context[u].visited) continue;
+            context[u].visited = true;
 
-        dijkstra(restrictedGraph, start, p, drivePath, driveTime, true);
-        dijkstra(restrictedGraph, p, end, walkPath, walkTime, false);
+            // Troca para a camada a pe nos estacionamentos
+            if (u != startIdx && u != endIdx && parkingData.at(network.getInfo(u))) {
+                push(u, WALKING, cur.total, 0, l);
+            }
+
+            for (int e = network.edgesBegin(u); e < network.edgesEnd(u); e++) {
+                if (network.getWeight(e) < 0) continue;
+                int v = network.getDest(e);
+                if (overlay.isBlocked(v) || overlay.isBlocked(u, v)) continue;
+                int newDist = cur.total + network.getWeight(e);
+                if (!context[v].visited && newDist < context[v].dist) {
+                    context[v].dist = newDist;
+                    push(v, DRIVING, newDist, 0, l);
+                }
+            }
+        } else {
+            if (cur.secondary >= context[n + u].dist) continue;   // dominated
+            context[n + u].dist = cur.secondary;
 
-        alternatives.emplace_back(p, drivePath, walkPath, driveTime + walkTime);
+            if (u == endIdx) {
+                found = l;
+                break;
+            }
+
+            for (int e = network.edgesBegin(u); e < network.edgesEnd(u); e++) {
+                int v = network.getDest(e);
+                if (overlay.isBlocked(v) || overlay.isBlocked(u, v)) continue;
+                int weight = network.getWalkingWeight(e);
+                int newWalk = cur.secondary + weight;
+                if (newWalk > maxWalkTime || newWalk >= context[n + v].dist) continue;
+                push(v, WALKING, cur.total + weight, newWalk, l);
+            }
+        }
     }
 
-    return alternatives;
-}
+    if (found == -1) return false;
 
+    drivingRoute.clear();
+    walkingRoute.clear();
+    int l = found;
+    for (; labels[l].layer == WALKING; l = labels[l].parent) {
+        walkingRoute.push_back(network.getInfo(labels[l].node));
+    }
+    for (; l != -1; l = labels[l].parent) {
+        drivingRoute.push_back(network.getInfo(labels[l].node));
+    }
+    reverse(walkingRoute.begin(), walkingRoute.end());
+    reverse(drivingRoute.begin(), drivingRoute.end());
+
+    parkingNode = drivingRoute.back();
+    totalTime = labels[found].total;
+    return true;
+}
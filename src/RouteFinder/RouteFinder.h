@@ -11,6 +11,13 @@
 #include <unordered_map>
 #include <tuple>
 #include "../Graph.h"
+#include "../CsrGraph.h"
+#include "SearchContext.h"
+#include "SearchOverlay.h"
+#include "../ParkingTable/ParkingTable.h"
+#include "../ContractionHierarchy/ContractionHierarchy.h"
+#include "../Landmarks/Landmarks.h"
+#include "../ThreadPool.h"
 
 using namespace std;
 class RouteFinder {
@@ -28,9 +35,122 @@ public:
  * @note Uses different weights for driving (edge weight) vs walking (walking weight)
  * @warning Nodes with negative weights are considered non-drivable when driving=true
  */
-    static bool dijkstra(Graph<int>& roadNetwork, int start, int end,
+    static bool dijkstra(const Graph<int>& roadNetwork, int start, int end,
                         std::vector<int>& path, int& total_time, bool driving);
 
+    /**
+ * @brief Dijkstra over the CSR representation of the road network
+ * @param network Immutable CSR network (see CsrGraph)
+ * @param context Per-query workspace; reset at the start of the search
+ * @param overlay Avoided nodes/segments (none by default)
+ * @param hierarchy Optional contraction hierarchy of the same network; answers
+ *        driving queries without avoided nodes/segments
+ * @param landmarks Optional landmark distances of the same network; the other
+ *        queries then run as A* (ALT) instead of Dijkstra
+ * @note Same semantics as the Graph overload, without touching any Vertex state.
+ *       Searches with distinct contexts may run concurrently on one network.
+ */
+    static bool dijkstra(const CsrGraph<int>& network, SearchContext& context, int start, int end,
+                        std::vector<int>& path, int& total_time, bool driving,
+                        const SearchOverlay& overlay = SearchOverlay(),
+                        const ContractionHierarchy* hierarchy = nullptr,
+                        const Landmarks* landmarks = nullptr);
+
+    /**
+ * @brief Bidirectional Dijkstra between two nodes
+ *
+ * Runs a forward search from start and a backward search (over incoming edges)
+ * from end, always advancing the one with the closer frontier, and stops once
+ * the two frontier distances add up to at least the best start-end path seen.
+ *
+ * @param forwardContext Workspace of the forward search
+ * @param backwardContext Workspace of the backward search (must be a different object)
+ * @note Same parameters and result as the CSR dijkstra; among paths of equal
+ *       time, the one returned may differ. Both searches use the queue picked
+ *       by forwardContext's policy.
+ * @note findHybridRoute and findAlternativeRoutes run their driving and walking
+ *       legs with it (RouteBenchmark p2p: about 40% fewer settled vertices)
+ */
+    static bool bidirectionalDijkstra(const CsrGraph<int>& network, SearchContext& forwardContext,
+                                      SearchContext& backwardContext, int start, int end,
+                                      std::vector<int>& path, int& total_time, bool driving,
+                                      const SearchOverlay& overlay = SearchOverlay());
+
+    /**
+ * @brief One-to-all Dijkstra from (or, if reverse, towards) a root node
+ * @param network CSR network
+ * @param[out] context Holds the tree afterwards: context[v].dist is the time from
+ *             the root to v (to the root when reverse) and context[v].path the
+ *             next vertex towards the root, both by dense index
+ * @param root ID of the root node
+ * @param driving Driving (edge weight) or walking weights
+ * @param reverse Follow incoming edges, giving times from every node to the root
+ * @param overlay Avoided nodes/segments
+ * @return false if the root does not exist or is avoided
+ */
+    static bool shortestPathTree(const CsrGraph<int>& network, SearchContext& context, int root,
+                                 bool driving, bool reverse,
+                                 const SearchOverlay& overlay = SearchOverlay());
+
+
+    /**
+ * @brief The K shortest loopless routes between two nodes (Yen's algorithm)
+ *
+ * Every spur search reuses the shortest-path tree towards end: a spur node
+ * whose tree path avoids the root path and the blocked next edges takes it
+ * without searching; otherwise an A* search runs with the tree distances as
+ * potentials, which stay exact lower bounds after the removals.
+ *
+ * @param k Number of routes wanted, the shortest included
+ * @param[out] routes Up to k routes (node IDs and time), by increasing time
+ * @param maxOverlap Largest fraction of a route's time, and of its segments,
+ *        that may be on segments of a better route already returned (1 keeps
+ *        every route)
+ * @param shortest Optional shortest route already known (e.g. from the
+ *        hierarchy), returned as the first one instead of the tree's
+ * @note Stops after examining YEN_PATHS_PER_ROUTE * k loopless routes, so with
+ *       a strict maxOverlap fewer than k routes may come back
+ * @return false if end cannot be reached
+ */
+    static bool kShortestPaths(const CsrGraph<int>& network, SearchContext& context, int start, int end,
+                               int k, std::vector<std::pair<std::vector<int>, int>>& routes,
+                               bool driving = true, double maxOverlap = 1.0,
+                               const SearchOverlay& overlay = SearchOverlay(),
+                               const std::vector<int>* shortest = nullptr);
+
+    static constexpr int YEN_PATHS_PER_ROUTE = 10;
+
+    /**
+ * @brief Alternative routes through via nodes (plateau method)
+ *
+ * One tree from start and one towards end give, for every node v, the route
+ * start -> v -> end along the two trees. Plateaus (chains of edges in both
+ * trees) make good via nodes; one node per plateau is tried, by increasing
+ * 2 * time - plateau time, and its route is returned if it is:
+ * - loopless and at most maxStretch times the shortest;
+ * - at most maxOverlap shared with the routes already returned (as in kShortestPaths);
+ * - locally optimal: the part of it within localOptimality * shortest time
+ *   on each side of v is a shortest path (checked with one search unless
+ *   the plateau already covers it).
+ *
+ * @param k Number of routes wanted, the shortest included
+ * @param[out] routes Up to k routes (node IDs and time); the shortest first,
+ *             then the alternatives by rank, not necessarily by time
+ * @param shortest Optional shortest route already known, as in kShortestPaths
+ * @note Examines at most VIA_CANDIDATES_PER_ROUTE * (k - 1) via nodes. The
+ *       stretch is bounded for the whole route, not for each of its parts.
+ * @return false if end cannot be reached
+ */
+    static bool viaNodeAlternatives(const CsrGraph<int>& network, SearchContext& context, int start, int end,
+                                    int k, std::vector<std::pair<std::vector<int>, int>>& routes,
+                                    bool driving = true, double maxStretch = VIA_MAX_STRETCH,
+                                    double maxOverlap = 1.0, double localOptimality = VIA_LOCAL_OPTIMALITY,
+                                    const SearchOverlay& overlay = SearchOverlay(),
+                                    const std::vector<int>* shortest = nullptr);
+
+    static constexpr double VIA_MAX_STRETCH = 1.25;
+    static constexpr double VIA_LOCAL_OPTIMALITY = 0.25;
+    static constexpr int VIA_CANDIDATES_PER_ROUTE = 20;
 
     /**
  * @brief Finds a hybrid driving-walking route with parking constraints
@@ -50,10 +170,51 @@ public:
  * @return true if a valid route was found within constraints, false otherwise
  * @details Considers parking nodes as transition points between driving and  walking
  * */
-    static bool findRouteWithIncludeNode(Graph<int>& roadNetwork, int start,
+    static bool findRouteWithIncludeNode(const Graph<int>& roadNetwork, int start,
                                        int end, int include,
                                        std::vector<int>& path, int& total_time);
 
+    static bool findRouteWithIncludeNode(const CsrGraph<int>& network, SearchContext& context, int start,
+                                       int end, int include,
+                                       std::vector<int>& path, int& total_time,
+                                       const SearchOverlay& overlay = SearchOverlay(),
+                                       const ContractionHierarchy* hierarchy = nullptr,
+                                       const Landmarks* landmarks = nullptr);
+
+    /**
+ * @brief Fastest driving route from start to end through every stop, in any order
+ *
+ * One tree from start and from every stop gives the table of times between
+ * them; the stops are then ordered by orderStops and the legs of that order
+ * joined into one path.
+ *
+ * @param include Stops (node IDs); repeated ones and start/end are visited once
+ * @note A single stop is left to findRouteWithIncludeNode, which also
+ *       uses the hierarchy and the landmarks
+ * @return false if a node does not exist or some stop cannot be visited
+ */
+    static bool findRouteWithIncludeNodes(const CsrGraph<int>& network, SearchContext& context, int start,
+                                        int end, const std::vector<int>& include,
+                                        std::vector<int>& path, int& total_time,
+                                        const SearchOverlay& overlay = SearchOverlay(),
+                                        const ContractionHierarchy* hierarchy = nullptr,
+                                        const Landmarks* landmarks = nullptr);
+
+    /**
+ * @brief Visiting order of the stops of a route from a table of times
+ * @param times times[i][j] from point i to point j, UNREACHABLE if there is
+ *        no route; point 0 is the start, the last point the end and the
+ *        others are the stops
+ * @param[out] order The stops (1 .. size - 2) in visiting order
+ * @param exact Held-Karp (O(2^s s^2) for s stops) instead of nearest
+ *        neighbour improved by 2-opt and Or-opt moves
+ * @return Time of the route in that order, UNREACHABLE if there is none
+ * @note findRouteWithIncludeNodes is exact up to HELD_KARP_MAX_STOPS stops
+ */
+    static long long orderStops(const std::vector<std::vector<int>>& times, std::vector<int>& order, bool exact);
+
+    static constexpr int HELD_KARP_MAX_STOPS = 12;
+
 
     /**
  * @brief Finds alternative hybrid routes when primary route doesn't meet constraints
@@ -71,7 +232,7 @@ public:
  *         - Total time
  * @note Returns up to 2 best alternatives sorted by total time
  */
-    static bool findHybridRoute(Graph<int>& roadNetwork,
+    static bool findHybridRoute(const Graph<int>& roadNetwork,
                               const std::unordered_map<int, bool>& parkingData,
                               int start, int end, int maxWalkTime,
                               const std::vector<int>& avoidNodes,
@@ -82,6 +243,35 @@ public:
                               std::string& message,
                               std::vector<std::tuple<int, std::vector<int>, std::vector<int>, int>>* alternatives);
 
+    /**
+ * @brief Hybrid route search over a CSR network
+ * @param network CSR network
+ * @param overlay Avoided nodes/segments, consulted instead of modifying the network
+ * @param parkingTable Optional precomputed walking times from parking nodes; used when
+ *        there are no avoided nodes/segments and it lists every parking node within
+ *        maxWalkTime of end, saving the walking search; the driving route then
+ *        comes from the driving tree, leaving a single walking leg to search
+ * @param pool Optional worker pool: the driving and walking searches, which are
+ *        independent, then run on separate workers, each with a search workspace
+ *        of its own (context serves one of them). The pool must not be the one
+ *        running this call.
+ * @note With context's HybridEngine::Layered, a single search over a driving and
+ *       a walking layer is tried first (parkingTable and pool are not used by it);
+ *       the two trees still run when it finds no route within maxWalkTime
+ * @note The Graph overload builds the network and overlay and delegates here
+ */
+    static bool findHybridRoute(const CsrGraph<int>& network, SearchContext& context,
+                              const std::unordered_map<int, bool>& parkingData,
+                              int start, int end, int maxWalkTime,
+                              const SearchOverlay& overlay,
+                              std::vector<int>& drivingRoute,
+                              std::vector<int>& walkingRoute,
+                              int& parkingNode, int& totalTime,
+                              std::string& message,
+                              std::vector<std::tuple<int, std::vector<int>, std::vector<int>, int>>* alternatives,
+                              const ParkingTable* parkingTable = nullptr,
+                              ThreadPool* pool = nullptr);
+
 
     /**
  * @brief Finds alternative driving-only routes between two nodes
@@ -97,12 +287,58 @@ public:
  */
     static std::vector<std::tuple<int, std::vector<int>, std::vector<int>, int>>
     findAlternativeRoutes(
-        Graph<int>& roadNetwork,
+        const Graph<int>& roadNetwork,
         const std::unordered_map<int, bool>& parkingData,
         int start, int end, int originalMaxWalkTime,
         const std::vector<int>& avoidNodes,
         const std::vector<std::pair<int, int>>& avoidSegments);
 
+    static std::vector<std::tuple<int, std::vector<int>, std::vector<int>, int>>
+    findAlternativeRoutes(
+        const CsrGraph<int>& network, SearchContext& context,
+        const std::unordered_map<int, bool>& parkingData,
+        int start, int end, int originalMaxWalkTime,
+        const SearchOverlay& overlay, ThreadPool* pool = nullptr);
+
+private:
+    /**
+ * @brief Hybrid route as a single search over a two-layer graph (HybridEngine::Layered)
+ *
+ * The driving layer (driving weights, drivable edges only) is linked to the
+ * walking layer (walking weights) at the parking nodes. Labels carry the total
+ * time and the walking time; those walking more than maxWalkTime are pruned
+ * and the search stops when the destination is settled on the walking layer.
+ * The labels, their heap and the per-node state live in context.
+ *
+ * @return Whether a route within maxWalkTime was found; among routes with the
+ *         same total time, the parking node chosen may differ from the two trees'
+ */
+    static bool layeredHybridRoute(const CsrGraph<int>& network, SearchContext& context,
+                                 const std::unordered_map<int, bool>& parkingData,
+                                 int startIdx, int endIdx, int maxWalkTime,
+                                 const SearchOverlay& overlay,
+                                 std::vector<int>& drivingRoute,
+                                 std::vector<int>& walkingRoute,
+                                 int& parkingNode, int& totalTime);
+
+    /**
+ * @brief Driving and walking times of every usable parking node
+ *
+ * Runs one driving tree from start and one reversed walking tree towards end,
+ * instead of two searches per parking node.
+ *
+ * @param[out] candidates {parkingNode, driveTime, walkTime} of every parking node
+ *             (other than start/end) reachable by car and from which end is reachable on foot
+ * @param[out] hasDrivingRoute Whether any parking node can be reached by car
+ * @param[out] hasWalkingRoute Whether end can be reached on foot from any parking node
+ */
+    static void collectParkingCandidates(const CsrGraph<int>& network, SearchContext& context,
+                                         const std::unordered_map<int, bool>& parkingData,
+                                         int start, int end, const SearchOverlay& overlay,
+                                         std::vector<std::tuple<int, int, int>>& candidates,
+                                         bool& hasDrivingRoute, bool& hasWalkingRoute,
+                                         ThreadPool* pool = nullptr);
+
 };
 
 #endif // ROUTEFINDER_H
\ No newline at end of file
@@ -0,0 +1,172 @@
+/**
+ * @file SearchContext.h
+ * @brief Per-query workspace for the RouteFinder searches
+ *
+ * Holds the distance, predecessor, visited and queue-index state that used
+ * to live inside Vertex, indexed by the dense vertex index of a CsrGraph.
+ * One context per thread lets several queries share one read-only network.
+ */
+#ifndef SEARCH_CONTEXT_H
+#define SEARCH_CONTEXT_H
+
+#include <vector>
+#include <tuple>
+#include <limits>
+#include <algorithm>
+#include "../Graph.h"
+#include "../MutablePriorityQueue.h"
+#include "../BucketQueue.h"
+#include "../RadixHeap.h"
+#include "../DaryHeap.h"
+
+/**
+ * @brief Priority queue used by the Dijkstra/A* searches of a context
+ *
+ * Auto picks one from the kind of search and the network weights.
+ */
+enum class QueuePolicy {
+    Auto, BinaryHeap, QuaternaryHeap, Dial, Radix,
+    DaryHeap4, DaryHeap8, LazyDaryHeap4, LazyDaryHeap8     // keys stored in the heap
+};
+
+/**
+ * @brief Engine of the driving-walking searches of a context (see RouteFinder::findHybridRoute)
+ */
+enum class HybridEngine {
+    TwoTrees,   // a driving tree from the source and a walking tree towards the destination
+    Layered     // one label search over a driving and a walking layer
+};
+
+/**
+ * @brief Search workspace for distances of type W
+ *
+ * Unreached vertices have dist == UNREACHABLE, the largest W; searches never
+ * add a weight to it.
+ */
+template <class W>
+class BasicSearchContext {
+public:
+    static constexpr W UNREACHABLE = std::numeric_limits<W>::max();
+
+    /**
+     * @brief Search state of one vertex
+     */
+    struct Node {
+        W dist = UNREACHABLE;
+        int path = -1;          // dense index of the predecessor, -1 for none
+        bool visited = false;
+        int queueIndex = 0;     // required by MutablePriorityQueue
+
+        bool operator<(Node &node) const { return dist < node.dist; }
+    };
+
+    /**
+     * @brief Label of a search over several layers of the network, where a
+     *        vertex may hold several labels (see RouteFinder::layeredHybridRoute)
+     */
+    struct Label {
+        int node;
+        int layer;
+        W total, secondary;     // the key, and the time that decides dominance
+        int parent;             // index of the previous label, -1 for none
+    };
+
+    using BinaryHeap = MutablePriorityQueue<Node>;
+    using QuaternaryHeap = MutablePriorityQueue<Node, 4>;
+    using DialQueue = BucketQueue<Node>;
+    using RadixQueue = RadixHeap<Node>;
+    using DaryHeap4 = DaryHeap<Node, 4>;
+    using DaryHeap8 = DaryHeap<Node, 8>;
+    using LazyDaryHeap4 = DaryHeap<Node, 4, true>;
+    using LazyDaryHeap8 = DaryHeap<Node, 8, true>;
+
+    BasicSearchContext() = default;
+    explicit BasicSearchContext(int numVertex) { reset(numVertex); }
+
+    /**
+     * @brief Starts a new search over a network with numVertex vertices
+     * @note O(1) unless the network grew or the Dial queue was left non-empty:
+     *       entries from older searches are recognised by their generation
+     *       and reinitialised on first access
+     */
+    void reset(int numVertex) {
+        if ((int) nodes.size() < numVertex) {
+            nodes.resize(numVertex);
+            stamps.resize(numVertex, 0);
+        }
+        if (++generation == 0) {
+            // wrapped around: every stamp could now look current
+            std::fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+        std::apply([](auto &... queue) { (queue.clear(), ...); }, queues);
+        std::get<DaryHeap4>(queues).setItems(nodes.data());
+        std::get<DaryHeap8>(queues).setItems(nodes.data());
+        std::get<LazyDaryHeap4>(queues).setItems(nodes.data());
+        std::get<LazyDaryHeap8>(queues).setItems(nodes.data());
+        numSettled = 0;
+        labelStore.clear();
+        labelHeap.clear();
+    }
+
+    Node &operator[](int v) {
+        if (stamps[v] != generation) {
+            stamps[v] = generation;
+            nodes[v] = Node();
+        }
+        return nodes[v];
+    }
+
+    /**
+     * @brief Dense index of a node handed out by operator[]
+     */
+    int indexOf(const Node *node) const { return node - nodes.data(); }
+
+    /**
+     * @brief One of the queues of the context (all are emptied by reset)
+     */
+    template <class Queue = BinaryHeap>
+    Queue &queue() { return std::get<Queue>(queues); }
+
+    /**
+     * @brief Labels of the current search, emptied by reset (capacity is kept)
+     */
+    std::vector<Label> &labels() { return labelStore; }
+
+    /**
+     * @brief Min-heap of {total, secondary, label index} for the labels, kept
+     *        with std::push_heap/pop_heap and std::greater; emptied by reset
+     */
+    std::vector<std::tuple<W, W, int>> &labelQueue() { return labelHeap; }
+
+    QueuePolicy getQueuePolicy() const { return queuePolicy; }
+    void setQueuePolicy(QueuePolicy policy) { queuePolicy = policy; }
+
+    HybridEngine getHybridEngine() const { return hybridEngine; }
+    void setHybridEngine(HybridEngine engine) { hybridEngine = engine; }
+
+    /**
+     * @brief Number of vertices settled since the last reset
+     */
+    int getNumSettled() const { return numSettled; }
+    void countSettled() { numSettled++; }
+
+private:
+    std::vector<Node> nodes;
+    std::vector<unsigned> stamps;
+    unsigned generation = 0;
+    std::tuple<BinaryHeap, QuaternaryHeap, DialQueue, RadixQueue,
+               DaryHeap4, DaryHeap8, LazyDaryHeap4, LazyDaryHeap8> queues;
+    QueuePolicy queuePolicy = QueuePolicy::Auto;
+    HybridEngine hybridEngine = HybridEngine::TwoTrees;
+    int numSettled = 0;
+    std::vector<Label> labelStore;
+    std::vector<std::tuple<W, W, int>> labelHeap;
+};
+
+/**
+ * @brief Workspace of the RouteFinder searches: integer times, as loaded by FileParser
+ */
+using SearchContext = BasicSearchContext<int>;
+
+#endif // SEARCH_CONTEXT_H
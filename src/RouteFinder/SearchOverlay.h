@@ -0,0 +1,84 @@
+/**
+ * @file SearchOverlay.h
+ * @brief AvoidNodes/AvoidSegments restrictions applied on top of a CsrGraph
+ *
+ * Instead of copying the network and removing vertices/edges, the searches
+ * consult the overlay while relaxing edges: blocked vertices are never
+ * reached and blocked edges are never relaxed. The network is not modified.
+ */
+#ifndef SEARCH_OVERLAY_H
+#define SEARCH_OVERLAY_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <unordered_set>
+#include "../CsrGraph.h"
+
+class SearchOverlay {
+public:
+    SearchOverlay() = default;
+
+    /**
+     * @brief Builds the overlay for the given avoid lists
+     * @param network Network whose dense indices the overlay refers to
+     * @param avoidNodes Node IDs that cannot be visited
+     * @param avoidSegments Segments (a,b) that cannot be used, in either direction
+     * @note IDs that do not exist in the network are ignored
+     */
+    SearchOverlay(const CsrGraph<int> &network, const std::vector<int> &avoidNodes,
+                  const std::vector<std::pair<int, int>> &avoidSegments) {
+        for (int node : avoidNodes) {
+            int v = network.findVertexIdx(node);
+            if (v != -1) blockVertex(v);
+        }
+        for (auto &seg : avoidSegments) {
+            int u = network.findVertexIdx(seg.first);
+            int v = network.findVertexIdx(seg.second);
+            if (u == -1 || v == -1) continue;
+            blockEdge(u, v);
+            blockEdge(v, u);
+        }
+    }
+
+    /*
+     * Blocks a vertex given its dense index.
+     */
+    void blockVertex(int v) {
+        unsigned word = v / 64;
+        if (word >= blockedVertices.size()) blockedVertices.resize(word + 1, 0);
+        blockedVertices[word] |= uint64_t(1) << (v % 64);
+        numBlockedVertices++;
+    }
+
+    /*
+     * Blocks the directed edge u->v (dense indices); parallel edges included.
+     */
+    void blockEdge(int u, int v) {
+        blockedEdges.insert(edgeKey(u, v));
+    }
+
+    bool isBlocked(int v) const {
+        unsigned word = v / 64;
+        return word < blockedVertices.size() && (blockedVertices[word] >> (v % 64) & 1);
+    }
+
+    bool isBlocked(int u, int v) const {
+        return !blockedEdges.empty() && blockedEdges.count(edgeKey(u, v));
+    }
+
+    bool empty() const {
+        return numBlockedVertices == 0 && blockedEdges.empty();
+    }
+
+private:
+    std::vector<uint64_t> blockedVertices;      // bitset over dense indices
+    std::unordered_set<uint64_t> blockedEdges;  // (u << 32 | v)
+    int numBlockedVertices = 0;
+
+    static uint64_t edgeKey(int u, int v) {
+        return (uint64_t(uint32_t(u)) << 32) | uint32_t(v);
+    }
+};
+
+#endif // SEARCH_OVERLAY_H
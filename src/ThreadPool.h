@@ -0,0 +1,152 @@
+/**
+ * @file ThreadPool.h
+ * @brief Fixed pool of worker threads with work stealing
+ */
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+/**
+ * @brief Fixed set of workers that run the iterations of parallelFor
+ *
+ * The iterations are cut into chunks dealt round-robin to per-worker deques.
+ * A worker takes chunks from the front of its own deque and, once it is
+ * empty, steals from the back of the others, so slow iterations (e.g. hybrid
+ * queries next to CH queries) do not leave cores idle.
+ *
+ * The body receives the worker index, so each worker can own its search
+ * workspace: state indexed by worker is never shared between threads.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param numThreads Number of workers; 0 uses one per hardware thread
+     */
+    explicit ThreadPool(unsigned numThreads = 0) {
+        if (numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned w = 0; w < numThreads; w++) queues.emplace_back(new WorkQueue());
+        for (unsigned w = 0; w < numThreads; w++) workers.emplace_back([this, w] { work(w); });
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    unsigned size() const { return workers.size(); }
+
+    /**
+     * @brief Runs body(i, worker) for every i in [0, count) and waits for all of them
+     * @param body Callable as body(int i, unsigned worker), worker in [0, size())
+     * @throws The first exception thrown by body, once every worker stopped
+     * @note Not reentrant: body must not call parallelFor on the same pool
+     */
+    template <class F>
+    void parallelFor(int count, F&& body) {
+        if (count <= 0) return;
+        int chunk = std::max(1, count / ((int) size() * CHUNKS_PER_WORKER));
+
+        std::unique_lock<std::mutex> lock(mutex);
+        unsigned w = 0;
+        for (int begin = 0; begin < count; begin += chunk, w = (w + 1) % size()) {
+            queues[w]->ranges.push_back({begin, std::min(count, begin + chunk)});
+        }
+        task = [&body](int i, unsigned worker) { body(i, worker); };
+        error = nullptr;
+        finishedWorkers = 0;
+        job++;
+        wake.notify_all();
+
+        // Every worker goes through every job, so none is left holding the task
+        done.wait(lock, [this] { return finishedWorkers == size(); });
+        task = nullptr;
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    static constexpr int CHUNKS_PER_WORKER = 8;
+
+    struct Range {
+        int begin, end;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    bool take(unsigned w, Range& range) {
+        {
+            WorkQueue& own = *queues[w];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.ranges.empty()) {
+                range = own.ranges.front();
+                own.ranges.pop_front();
+                return true;
+            }
+        }
+        for (unsigned k = 1; k < size(); k++) {
+            WorkQueue& victim = *queues[(w + k) % size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.ranges.empty()) {
+                range = victim.ranges.back();
+                victim.ranges.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(unsigned w) {
+        unsigned seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || job != seen; });
+                if (stopping) return;
+                seen = job;
+            }
+
+            Range range;
+            while (take(w, range)) {
+                try {
+                    for (int i = range.begin; i < range.end; i++) task(i, w);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error) error = std::current_exception();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++finishedWorkers == size()) done.notify_one();
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;                   // guards everything below
+    std::condition_variable wake, done;
+    std::function<void(int, unsigned)> task;
+    std::exception_ptr error;
+    unsigned job = 0, finishedWorkers = 0;
+    bool stopping = false;
+};
+
+#endif // THREAD_POOL_H
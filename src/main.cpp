@@ -9,11 +9,31 @@
 #include <iostream>
 #include <fstream>
 #include <unordered_map>
+#include <optional>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
 #include "Graph.h"
+#include "CsrGraph.h"
 #include "FileParser/FileParser.h"
 #include "InputParser/InputParser.h"
 #include "OutputWriter/OutputWriter.h"
 #include "RouteFinder/RouteFinder.h"
+#include "ParkingTable/ParkingTable.h"
+#include "ContractionHierarchy/ContractionHierarchy.h"
+#include "Landmarks/Landmarks.h"
+#include "BatchExecutor/BatchExecutor.h"
+#include "GraphSnapshot/GraphSnapshot.h"
+
+#define LOCATIONS_FILE "../data/locations.csv"
+#define DISTANCES_FILE "../data/Distances.csv"
+#define GRAPH_SNAPSHOT_FILE "../data/network.bin"
+#define PARKING_TABLE_FILE "../data/parking_table.bin"
+#define HIERARCHY_FILE "../data/hierarchy.bin"
+#define LANDMARKS_FILE "../data/landmarks.bin"
+#define PARKING_TABLE_K 8
+#define LANDMARK_COUNT 16
+#define HYBRID_THREADS 4
 
 using namespace std;
 
@@ -27,6 +47,7 @@ void showMainMenu() {
     cout << "1. Executar com arquivo input.txt (gera output.txt)" << endl;
     cout << "2. Inserir parametros manualmente" << endl;
     cout << "3. Sair" << endl;
+    cout << "4. Pre-calcular tabela de estacionamentos (" << PARKING_TABLE_FILE << ")" << endl;
     cout << "Escolha: ";
 }
 
@@ -34,46 +55,185 @@ void showMainMenu() {
  * @brief Processes the user's menu choice
  *
  * @param choice The user's menu selection
- * @param roadNetwork Reference to the graph representing the road network
+ * @param network CSR network of the roads
  * @param parkingData Reference to the parking availability data
+ * @param parkingTable Precomputed parking walking times, if loaded or built
+ * @param hierarchy Contraction hierarchy of the driving network
+ * @param landmarks Landmark distances for the A* searches
+ * @param pool Workers for the searches of a single driving-walking query, if any
+ * @param batchPool Workers for the queries of a multi-query input.txt, if any
  * @return bool True to continue the menu loop, false to exit
  */
-bool processChoice(const string& choice, Graph<int>& roadNetwork, unordered_map<int, bool>& parkingData) {
+bool processChoice(const string& choice, const CsrGraph<int>& network, unordered_map<int, bool>& parkingData,
+                   optional<ParkingTable>& parkingTable, const ContractionHierarchy& hierarchy,
+                   const Landmarks& landmarks, ThreadPool* pool, ThreadPool* batchPool) {
+    const ParkingTable* table = parkingTable ? &*parkingTable : nullptr;
     if (choice == "1") {
-        InputParser::processFileInput(roadNetwork, parkingData);
+        InputParser::processFileInput(network, parkingData, table, &hierarchy, &landmarks, pool, batchPool);
         return false; // Don't continue the loop
     }
     else if (choice == "2") {
-        InputParser::processManualInput(roadNetwork, parkingData);
+        InputParser::processManualInput(network, parkingData, table, &hierarchy, &landmarks, pool);
         return false; // Don't continue the loop
     }
     else if (choice == "3") {
         return false; // Exit
     }
+    else if (choice == "4") {
+        parkingTable = ParkingTable::build(network, parkingData, PARKING_TABLE_K);
+        // A tabela fica em memoria mesmo que nao possa ser gravada
+        try {
+            parkingTable->save(PARKING_TABLE_FILE);
+            cout << "Tabela gravada em " << PARKING_TABLE_FILE << endl;
+        } catch (const exception& e) {
+            cerr << "AVISO: " << e.what() << endl;
+        }
+        return true; // Continue the loop
+    }
     else {
         cout << "Opcao invalida!" << endl;
         return true; // Continue the loop
     }
 }
 
+/**
+ * @brief Whether the snapshot exists and is newer than both CSV files
+ */
+bool isSnapshotCurrent() {
+    namespace fs = std::filesystem;
+    error_code ec;
+    auto snapshotTime = fs::last_write_time(GRAPH_SNAPSHOT_FILE, ec);
+    if (ec) return false;
+    for (const char* csv : {LOCATIONS_FILE, DISTANCES_FILE}) {
+        auto csvTime = fs::last_write_time(csv, ec);
+        if (!ec && csvTime > snapshotTime) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Loads the network from the snapshot, or parses the CSV files and writes the snapshot
+ * @param parkingData[out] Map of parking availability (node ID -> isParking)
+ */
+GraphSnapshot loadNetwork(unordered_map<int, bool>& parkingData) {
+    if (isSnapshotCurrent()) {
+        try {
+            GraphSnapshot snapshot = GraphSnapshot::load(GRAPH_SNAPSHOT_FILE);
+            parkingData = snapshot.getParkingData();
+            return snapshot;
+        } catch (const exception& e) {
+            cerr << "AVISO: " << e.what() << endl;
+        }
+    }
+
+    Graph<int> roadNetwork;
+    parkingData.clear();
+    auto codeToId = FileParser::loadLocationMappings(LOCATIONS_FILE, parkingData);
+    FileParser::loadGraph(roadNetwork, DISTANCES_FILE, codeToId);
+    try {
+        GraphSnapshot::write(GRAPH_SNAPSHOT_FILE, CsrGraph<int>(roadNetwork), codeToId, parkingData);
+        return GraphSnapshot::load(GRAPH_SNAPSHOT_FILE);
+    } catch (const exception& e) {
+        cerr << "AVISO: " << e.what() << endl;
+    }
+    return GraphSnapshot(CsrGraph<int>(roadNetwork));
+}
+
+/**
+ * @brief Reads data precomputed for the network from filename, or computes it and saves it there
+ *
+ * T::load rejects a file computed for another network (the CSV files changed
+ * since), which is then recomputed and overwritten.
+ *
+ * @param build Computes the data
+ */
+template <class T, class Build>
+T loadOrBuild(const char* filename, const CsrGraph<int>& network, Build build) {
+    if (ifstream(filename).good()) {
+        try {
+            return T::load(filename, network);
+        } catch (const exception& e) {
+            cerr << "AVISO: " << e.what() << endl;
+        }
+    }
+    T data = build();
+    try {
+        data.save(filename);
+    } catch (const exception& e) {
+        cerr << "AVISO: " << e.what() << endl;
+    }
+    return data;
+}
+
 /**
  * @brief Main function of the program
  *
  * Initializes the system, loads data, and manages the main menu loop.
+ * The network is mapped from GRAPH_SNAPSHOT_FILE, which is (re)written from
+ * the CSV files whenever it is missing or older than them; the contraction
+ * hierarchy and the landmark distances are kept next to it in HIERARCHY_FILE
+ * and LANDMARKS_FILE.
+ * Called as "RoutePlanner <input> <output> [threads]", runs every query of
+ * the input file as a batch (see BatchExecutor) without the menu, on every
+ * hardware thread unless a number of threads is given.
  *
  * @return int Program exit status (0 for success, 1 for error)
  */
-int main() {
+int main(int argc, char* argv[]) {
     try {
         cout << "=== BATCH MODE ===" << endl;
 
-        // Inicialização do grafo
-        Graph<int> roadNetwork;
+        // Carregar dados (do snapshot binario quando esta atualizado)
         unordered_map<int, bool> parkingData;
+        GraphSnapshot snapshot = loadNetwork(parkingData);
+        const CsrGraph<int>& network = snapshot.getNetwork();
+        ContractionHierarchy hierarchy = loadOrBuild<ContractionHierarchy>(HIERARCHY_FILE, network, [&]() {
+            return ContractionHierarchy(network);
+        });
+        Landmarks landmarks = loadOrBuild<Landmarks>(LANDMARKS_FILE, network, [&]() {
+            return Landmarks::build(network, LANDMARK_COUNT);
+        });
 
-        // Carregar dados
-        auto codeToId = FileParser::loadLocationMappings("../data/locations.csv", parkingData);
-        FileParser::loadGraph(roadNetwork, "../data/Distances.csv", codeToId);
+        // Tabela de estacionamentos (opcional, gerada pela opcao 4)
+        optional<ParkingTable> parkingTable;
+        if (ifstream(PARKING_TABLE_FILE).good()) {
+            try {
+                parkingTable = ParkingTable::load(PARKING_TABLE_FILE, network, parkingData);
+            } catch (const exception& e) {
+                cerr << "AVISO: " << e.what() << endl;
+            }
+        }
+
+        // Lote pela linha de comandos
+        if (argc == 3 || argc == 4) {
+            ifstream input(argv[1]);
+            if (!input.is_open()) {
+                throw runtime_error("ERRO: Arquivo " + string(argv[1]) + " nao encontrado");
+            }
+            ofstream out(argv[2]);
+            if (!out.is_open()) {
+                throw runtime_error("ERRO: Impossivel criar " + string(argv[2]));
+            }
+            unsigned threads = argc == 4 ? stoi(argv[3]) : 0;
+            vector<Query> queries = InputParser::parseQueries(input);
+            const ParkingTable* table = parkingTable ? &*parkingTable : nullptr;
+            int invalid = BatchExecutor::run(network, parkingData, queries, out, table, &hierarchy, &landmarks,
+                                             threads);
+            cout << queries.size() << " consultas (" << invalid << " invalidas) gravadas em " << argv[2] << endl;
+            return 0;
+        }
+
+        // Trabalhadores para as pesquisas independentes de uma rota hibrida
+        optional<ThreadPool> hybridPool;
+        if (thread::hardware_concurrency() > 1) {
+            hybridPool.emplace(min<unsigned>(HYBRID_THREADS, thread::hardware_concurrency()));
+        }
+
+        // Trabalhadores para um lote em input.txt, um por nucleo
+        optional<ThreadPool> batchPool;
+        if (thread::hardware_concurrency() > 1) {
+            batchPool.emplace();
+        }
 
         // Menu principal
         while (true) {
@@ -82,7 +242,8 @@ int main() {
             string choice;
             getline(cin, choice);
 
-            if (!processChoice(choice, roadNetwork, parkingData)) {
+            if (!processChoice(choice, network, parkingData, parkingTable, hierarchy, landmarks,
+                               hybridPool ? &*hybridPool : nullptr, batchPool ? &*batchPool : nullptr)) {
                 break;
             }
         }